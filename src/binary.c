@@ -0,0 +1,185 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "binary.h"
+#include "io.h"
+#include "pool.h"
+
+
+
+/*
+ * Binary detection only ever looks at the first few kilobytes of a file, so deciding to skip a 2 GB
+ * core dump costs a single small read. A sample is binary when it contains a NUL byte, which text in
+ * any ASCII-compatible encoding never does, or when more than BINARY_SUSPECT_PERCENT of its bytes are
+ * either part of an invalid UTF-8 sequence or a control character that does not occur in text. Random
+ * or compressed data comes out at about 55%, while even accent-heavy Latin-1 text stays well below 30%.
+ */
+#define BINARY_SUSPECT_PERCENT 30
+
+const char *binaryPolicyNames[] = { "analyze", "size", "skip" };
+
+
+
+
+
+/*
+ * This function resolves a --binary policy name, returning 0 on success or -1 for an unknown name.
+ */
+int binaryParsePolicy(const char *name, BinaryPolicy *policy) {
+    for (int i = 0; i <= BINARY_SKIP; i++) {
+        if (strcmp(name, binaryPolicyNames[i]) == 0) {
+            *policy = (BinaryPolicy)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+
+
+
+
+/*
+ * This function returns the length of the valid UTF-8 sequence starting at p, 0 if the bytes there do
+ * not form one, or -1 if the sequence is valid so far but runs past end.
+ */
+static int utf8Sequence(const unsigned char *p, const unsigned char *end) {
+    int length;
+    unsigned char min = 0x80, max = 0xbf;
+    if (*p >= 0xc2 && *p <= 0xdf)
+        length = 2;
+    else if (*p >= 0xe0 && *p <= 0xef) {
+        length = 3;
+        if (*p == 0xe0)
+            min = 0xa0;
+        else if (*p == 0xed)
+            max = 0x9f;
+    } else if (*p >= 0xf0 && *p <= 0xf4) {
+        length = 4;
+        if (*p == 0xf0)
+            min = 0x90;
+        else if (*p == 0xf4)
+            max = 0x8f;
+    } else
+        return 0;
+
+    for (int i = 1; i < length; i++) {
+        if (p + i >= end)
+            return -1;
+        if (p[i] < (i == 1 ? min : 0x80) || p[i] > (i == 1 ? max : 0xbf))
+            return 0;
+    }
+    return length;
+}
+
+
+
+
+
+/*
+ * This function decides whether a sample of a file looks like binary data. truncated tells that the
+ * file continues after the sample, so a multi-byte character cut off at its end is not held against it.
+ */
+int binaryLooksBinary(const void *data, size_t len, int truncated) {
+    const unsigned char *p = data, *end = p + len;
+    if (memchr(p, 0, len))
+        return 1;
+
+    size_t suspect = 0;
+    while (p < end) {
+        unsigned char c = *p;
+        if (c < 0x80) {
+            if ((c < 0x20 && c != '\t' && c != '\n' && c != '\r' && c != '\f' && c != '\v' && c != '\b' && c != 0x1b) || c == 0x7f)
+                suspect++;
+            p++;
+            continue;
+        }
+        int length = utf8Sequence(p, end);
+        if (length < 0 && truncated)
+            break;
+        if (length <= 0) {
+            suspect++;
+            p++;
+        } else
+            p += length;
+    }
+    return suspect * 100 > len * BINARY_SUSPECT_PERCENT;
+}
+
+
+
+
+
+/*
+ * This function reads up to sampleBytes from the start of a file and returns 1 if it looks binary, 0 if
+ * it looks like text, or -1 if the file could not be read. A sample larger than BINARY_DEFAULT_SAMPLE
+ * is reserved against --max-memory; when the budget has no room, the default sample is used instead.
+ * The reads are charged to --max-read-rate and --max-iops like every other read of file content.
+ */
+int binarySniffFile(const char *path, uint64_t sampleBytes) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+    unsigned char stackBuffer[BINARY_DEFAULT_SAMPLE];
+    unsigned char *buffer = stackBuffer;
+    if (sampleBytes > sizeof(stackBuffer)) {
+        int reserved = poolReserve(sampleBytes) == 0;
+        if (reserved && (buffer = malloc(sampleBytes)) == NULL)
+            poolUnreserve(sampleBytes);
+        if (!reserved || !buffer) {
+            buffer = stackBuffer;
+            sampleBytes = sizeof(stackBuffer);
+        }
+    }
+
+    int binary = -1;
+    size_t got = 0;
+    while (got < sampleBytes) {
+        ssize_t n = pread(fd, buffer + got, sampleBytes - got, (off_t)got);
+        if (n <= 0) {
+            if (n == 0)
+                binary = 0;
+            break;
+        }
+        got += (size_t)n;
+        ioThrottle((uint64_t)n);
+    }
+    if (got == sampleBytes || binary == 0)
+        binary = binaryLooksBinary(buffer, got, got == sampleBytes);
+
+    if (buffer != stackBuffer) {
+        free(buffer);
+        poolUnreserve(sampleBytes);
+    }
+    close(fd);
+    return binary;
+}
@@ -0,0 +1,48 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_BINARY_H
+#define CLEN_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BINARY_DEFAULT_SAMPLE (8u * 1024)
+
+typedef enum {
+    BINARY_ANALYZE,
+    BINARY_SIZE,
+    BINARY_SKIP
+} BinaryPolicy;
+
+extern const char *binaryPolicyNames[];
+
+int binaryParsePolicy(const char *name, BinaryPolicy *policy);
+int binaryLooksBinary(const void *data, size_t len, int truncated);
+int binarySniffFile(const char *path, uint64_t sampleBytes);
+
+#endif
@@ -0,0 +1,308 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "blockindex.h"
+#include "hash.h"
+#include "io.h"
+#include "pool.h"
+
+
+
+/*
+ * The block index is a sidecar file (FILE.clenidx) that splits a large file into fixed-size blocks
+ * and stores, for every block, a content hash and the block's metric summary. On the next run a block
+ * whose hash is unchanged is not analyzed again; its stored summary is merged in instead.
+ *
+ * A block's counts only depend on its bytes and on the state it starts in (inside a word or not, and
+ * which quote, if any, is open), so every summary records that entry state together with the exit
+ * state and the counter deltas. A summary is reused only when the block starts in the same state it
+ * did last time. An edit that opens or closes a quote therefore re-analyzes the following blocks until
+ * the state lines up again, which is exactly what correctness requires.
+ *
+ * If the file's size and modification time still match the index header, the stored summaries are
+ * simply replayed and the file is not read at all. Otherwise every block is read and hashed, which is
+ * much cheaper than analyzing it, and only changed blocks go through the analyzer.
+ */
+#define INDEX_MAGIC   "CLENIDX1"
+#define INDEX_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t metrics;
+    uint64_t blockSize;
+    uint64_t fileSize;
+    uint64_t mtimeNs;
+    uint64_t blockCount;
+} IndexHeader;
+
+typedef struct {
+    uint64_t hash;
+    uint32_t entryFlags;
+    uint32_t exitFlags;
+    uint64_t exitSpecCount;
+    clen_result counts;
+} IndexBlock;
+
+
+
+
+
+/*
+ * These helpers pack the small per-block entry and exit states into one comparable word and back.
+ */
+static uint32_t packFlags(const clen_state *state) {
+    return state->inWord | (state->quoteOpen << 8) | (state->quoteSpecOpen << 16);
+}
+
+static void unpackFlags(clen_state *state, uint32_t flags) {
+    state->inWord = flags & 0xFF;
+    state->quoteOpen = (flags >> 8) & 0xFF;
+    state->quoteSpecOpen = (flags >> 16) & 0xFF;
+}
+
+
+
+
+
+/*
+ * This function advances the running state over one block summary. A block that closed a quote
+ * (its quote count grew) restarted the speculative quote count, otherwise the block's speculative
+ * pairs continue the count carried in from before.
+ */
+static void applyBlock(clen_state *state, const IndexBlock *block) {
+    uint64_t spec = block->counts.quotes ? block->exitSpecCount : state->quoteSpecCount + block->exitSpecCount;
+    clen_merge(&state->counts, &block->counts);
+    unpackFlags(state, block->exitFlags);
+    state->quoteSpecCount = spec;
+}
+
+
+
+
+
+/*
+ * This function loads the sidecar index of a file if it exists and was built with the same metric mask
+ * and block size. It returns a malloc'd array of the stored blocks (NULL when there is no usable index)
+ * and fills the header. The header comes from disk and may be damaged, so the block count has to be
+ * the one its file size implies and small enough that the size check below cannot overflow.
+ */
+static IndexBlock *loadIndex(const char *indexPath, unsigned metrics, size_t blockSize, IndexHeader *header) {
+    int fd = open(indexPath, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;
+    IndexBlock *blocks = NULL;
+    struct stat st;
+    if (read(fd, header, sizeof(*header)) == (ssize_t)sizeof(*header) &&
+        memcmp(header->magic, INDEX_MAGIC, sizeof(header->magic)) == 0 &&
+        header->version == INDEX_VERSION &&
+        header->metrics == metrics &&
+        header->blockSize == blockSize &&
+        header->blockCount == header->fileSize / blockSize + (header->fileSize % blockSize != 0) &&
+        header->blockCount <= (SIZE_MAX - sizeof(*header)) / sizeof(IndexBlock) &&
+        fstat(fd, &st) == 0 &&
+        (uint64_t)st.st_size == sizeof(*header) + header->blockCount * sizeof(IndexBlock)) {
+        size_t bytes = (size_t)header->blockCount * sizeof(IndexBlock);
+        blocks = malloc(bytes ? bytes : 1);
+        if (blocks && read(fd, blocks, bytes) != (ssize_t)bytes) {
+            free(blocks);
+            blocks = NULL;
+        }
+    }
+    close(fd);
+    return blocks;
+}
+
+
+
+
+
+/*
+ * This function writes the new index next to the file. It goes to a freshly created temporary file with
+ * a unique name first and is renamed into place, so a crash never leaves a torn index behind and
+ * concurrent runs never write into each other's file. The index summarizes the file's content, so it
+ * gets the file's read and write permissions (mode) and nothing more. Failing to write it (for example
+ * in a read-only directory) is not an error; the next run just analyzes the whole file again.
+ */
+static void saveIndex(const char *indexPath, mode_t mode, const IndexHeader *header, const IndexBlock *blocks) {
+    char tempPath[PATH_MAX + 8];
+    snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", indexPath);
+    int fd = mkostemp(tempPath, O_CLOEXEC);
+    if (fd < 0)
+        return;
+    if (fchmod(fd, mode & 0666) != 0) {
+        close(fd);
+        unlink(tempPath);
+        return;
+    }
+    size_t bytes = (size_t)header->blockCount * sizeof(IndexBlock);
+    int ok = write(fd, header, sizeof(*header)) == (ssize_t)sizeof(*header) &&
+             write(fd, blocks, bytes) == (ssize_t)bytes;
+    close(fd);
+    if (!ok || rename(tempPath, indexPath) != 0)
+        unlink(tempPath);
+}
+
+
+
+
+
+/*
+ * This function streams one block of the file through a pool buffer into the analyzer or the content
+ * hash, so blocks of any size are handled in bounded memory. A changed block is read twice, once to
+ * hash it and once more (from the page cache) to analyze it. It returns 0 on success and -1 when the
+ * block could not be read completely.
+ */
+static int streamBlock(int fd, unsigned char *buffer, uint64_t offset, size_t want, clen_ctx *ctx, HashState *hash) {
+    size_t have = 0;
+    while (have < want) {
+        size_t piece = want - have < POOL_BUFFER_SIZE ? want - have : POOL_BUFFER_SIZE;
+        ssize_t got = pread(fd, buffer, piece, (off_t)(offset + have));
+        if (got <= 0)
+            return -1;
+        if (ctx)
+            clen_feed(ctx, buffer, (size_t)got);
+        if (hash)
+            hashUpdate(hash, buffer, (size_t)got);
+        have += (size_t)got;
+        ioThrottle((uint64_t)got);
+    }
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function analyzes a file with the help of its block index, re-analyzing only blocks that
+ * changed since the index was written, and then refreshes the index. The context ends up in the same
+ * state as if the whole file had been fed to it. It returns 0 on success and -1 on a read error.
+ */
+int analyzeFileIndexed(const char *path, clen_ctx *ctx, clen_result *result, size_t blockSize) {
+    unsigned metrics = clen_metrics(ctx);
+    char indexPath[PATH_MAX];
+    if (snprintf(indexPath, sizeof(indexPath), "%s%s", path, BLOCK_INDEX_SUFFIX) >= (int)sizeof(indexPath))
+        return analyzeFile(path, ctx, result, NULL);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    uint64_t mtimeNs = (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec;
+
+    IndexHeader old;
+    IndexBlock *oldBlocks = loadIndex(indexPath, metrics, blockSize, &old);
+    clen_state state;
+    memset(&state, 0, sizeof(state));
+
+    // --> UNCHANGED FILE: REPLAY THE STORED SUMMARIES WITHOUT READING IT
+    if (oldBlocks && old.fileSize == (uint64_t)st.st_size && old.mtimeNs == mtimeNs) {
+        for (uint64_t i = 0; i < old.blockCount; i++)
+            applyBlock(&state, &oldBlocks[i]);
+        free(oldBlocks);
+        close(fd);
+        clen_restore(ctx, &state);
+        clen_finish(ctx, result);
+        return 0;
+    }
+
+    uint64_t blockCount = ((uint64_t)st.st_size + blockSize - 1) / blockSize;
+    IndexBlock *blocks = malloc((size_t)(blockCount ? blockCount : 1) * sizeof(IndexBlock));
+    void *buffer = NULL;
+    int status = blocks && poolAcquire(&buffer, 1) == 0 ? 0 : -1;
+
+    for (uint64_t i = 0; status == 0 && i < blockCount; i++) {
+        uint64_t offset = i * blockSize;
+        size_t want = (size_t)((uint64_t)st.st_size - offset < blockSize ? (uint64_t)st.st_size - offset : blockSize);
+        IndexBlock *block = &blocks[i];
+        HashState hashState;
+        hashInit(&hashState, 0);
+        if (streamBlock(fd, buffer, offset, want, NULL, &hashState) != 0) {
+            status = -1;
+            break;
+        }
+
+        block->hash = hashFinal(&hashState);
+        uint32_t entryFlags = packFlags(&state);
+        if (oldBlocks && i < old.blockCount && oldBlocks[i].hash == block->hash && oldBlocks[i].entryFlags == entryFlags) {
+            *block = oldBlocks[i];
+        } else {
+            clen_state entry, after;
+            memset(&entry, 0, sizeof(entry));
+            unpackFlags(&entry, entryFlags);
+            clen_restore(ctx, &entry);
+            if (streamBlock(fd, buffer, offset, want, ctx, NULL) != 0) {
+                status = -1;
+                break;
+            }
+            clen_save(ctx, &after);
+            block->entryFlags = entryFlags;
+            block->exitFlags = packFlags(&after);
+            block->exitSpecCount = after.quoteSpecCount;
+            block->counts = after.counts;
+        }
+        applyBlock(&state, block);
+    }
+
+    if (status == 0) {
+        struct stat now;
+        if (fstat(fd, &now) == 0 && now.st_size == st.st_size &&
+            now.st_mtim.tv_sec == st.st_mtim.tv_sec && now.st_mtim.tv_nsec == st.st_mtim.tv_nsec) {
+            IndexHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+            header.version = INDEX_VERSION;
+            header.metrics = metrics;
+            header.blockSize = blockSize;
+            header.fileSize = (uint64_t)st.st_size;
+            header.mtimeNs = mtimeNs;
+            header.blockCount = blockCount;
+            saveIndex(indexPath, st.st_mode, &header, blocks);
+        }
+        clen_restore(ctx, &state);
+        clen_finish(ctx, result);
+    }
+
+    free(oldBlocks);
+    free(blocks);
+    if (buffer)
+        poolRelease(&buffer, 1);
+    close(fd);
+    return status;
+}
@@ -0,0 +1,427 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+
+#include "cache.h"
+
+
+
+/*
+ * The result cache is a single file holding an open-addressing hash table that is mmap'd as a whole.
+ * Each slot is keyed by the file identity (device, inode) plus the metric mask, and remembers the size
+ * and modification time the file had when it was analyzed. A lookup only counts as a hit when size and
+ * mtime still match, so an edited file misses and its slot is overwritten by the fresh result.
+ *
+ * Slots are probed linearly. Removed slots become tombstones so probe chains stay intact; the table is
+ * rebuilt at twice the size once live slots plus tombstones pass 70% of the capacity. Entries remember
+ * when they were last used, which lets cacheCompact() drop results for files that have not been seen
+ * for CACHE_STALE_DAYS (deleted or moved files can never be looked up again by inode).
+ *
+ * The file can be torn or corrupted behind our back, so nothing in it is trusted to terminate a loop:
+ * a probe gives up after visiting every slot, and a table found without room is formatted afresh.
+ *
+ * The whole run holds an exclusive flock() on the cache file. A second CLEN running at the same time
+ * does not wait for it but simply runs without the cache.
+ */
+#define CACHE_MAGIC            "CLENCAC1"
+#define CACHE_VERSION          1
+#define CACHE_INITIAL_CAPACITY 4096
+#define CACHE_STALE_DAYS       30
+
+#define SLOT_EMPTY             0
+#define SLOT_LIVE              1
+#define SLOT_TOMBSTONE         2
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t capacity;
+    uint64_t live;
+    uint64_t tombstones;
+} CacheHeader;
+
+typedef struct {
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    uint64_t mtimeNs;
+    uint32_t metrics;
+    uint32_t state;
+    uint64_t lastUsed;
+    clen_result result;
+} CacheEntry;
+
+struct Cache {
+    int fd;
+    size_t mappedSize;
+    CacheHeader *header;
+    CacheEntry *entries;
+};
+
+
+
+
+
+/*
+ * This function returns the default cache location: $XDG_CACHE_HOME/clen/results.cache, falling back
+ * to ~/.cache/clen/results.cache. The directory is created when it does not exist yet.
+ */
+const char *cacheDefaultPath(char *buf, size_t size) {
+    const char *base = getenv("XDG_CACHE_HOME");
+    char dir[4096];
+    if (base && *base)
+        snprintf(dir, sizeof(dir), "%s/clen", base);
+    else if ((base = getenv("HOME")) && *base) {
+        snprintf(dir, sizeof(dir), "%s/.cache", base);
+        mkdir(dir, 0700);
+        snprintf(dir, sizeof(dir), "%s/.cache/clen", base);
+    } else
+        return NULL;
+    mkdir(dir, 0700);
+    snprintf(buf, size, "%s/results.cache", dir);
+    return buf;
+}
+
+
+
+
+
+/*
+ * This function mixes the slot key into a well-distributed 64-bit hash (the splitmix64 finalizer).
+ */
+static uint64_t cacheHash(uint64_t dev, uint64_t ino, uint32_t metrics) {
+    uint64_t h = ino ^ (dev * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t)metrics << 56);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+
+
+
+
+/*
+ * This function returns a file's modification time in nanoseconds since the epoch.
+ */
+static uint64_t mtimeNanos(const struct stat *st) {
+    return (uint64_t)st->st_mtim.tv_sec * 1000000000ULL + (uint64_t)st->st_mtim.tv_nsec;
+}
+
+
+
+
+
+/*
+ * This function (re)maps the cache file for the given capacity, growing the file first when needed.
+ * It returns 0 on success and -1 on failure, in which case the cache is left unmapped.
+ */
+static int cacheMap(Cache *cache, uint64_t capacity) {
+    if (cache->header)
+        munmap(cache->header, cache->mappedSize);
+    cache->header = NULL;
+    cache->entries = NULL;
+
+    size_t size = sizeof(CacheHeader) + (size_t)capacity * sizeof(CacheEntry);
+    if (ftruncate(cache->fd, (off_t)size) != 0)
+        return -1;
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, cache->fd, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    cache->mappedSize = size;
+    cache->header = map;
+    cache->entries = (CacheEntry *)(cache->header + 1);
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function empties the table and sets it up with the given capacity (a power of two).
+ */
+static int cacheFormat(Cache *cache, uint64_t capacity) {
+    if (cacheMap(cache, capacity) != 0)
+        return -1;
+    memset(cache->header, 0, cache->mappedSize);
+    memcpy(cache->header->magic, CACHE_MAGIC, sizeof(cache->header->magic));
+    cache->header->version = CACHE_VERSION;
+    cache->header->entrySize = sizeof(CacheEntry);
+    cache->header->capacity = capacity;
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function finds the slot for a key. It returns the live slot holding the key if there is one,
+ * otherwise the first reusable slot (tombstone or empty) on the probe chain, or NULL when a corrupt
+ * table has neither.
+ */
+static CacheEntry *cacheFind(const Cache *cache, uint64_t dev, uint64_t ino, uint32_t metrics) {
+    uint64_t mask = cache->header->capacity - 1;
+    CacheEntry *reusable = NULL;
+    uint64_t i = cacheHash(dev, ino, metrics) & mask;
+    for (uint64_t probes = 0; probes < cache->header->capacity; probes++, i = (i + 1) & mask) {
+        CacheEntry *entry = &cache->entries[i];
+        if (entry->state == SLOT_EMPTY)
+            return reusable ? reusable : entry;
+        if (entry->state == SLOT_TOMBSTONE) {
+            if (!reusable)
+                reusable = entry;
+        } else if (entry->dev == dev && entry->ino == ino && entry->metrics == metrics) {
+            return entry;
+        }
+    }
+    return reusable;
+}
+
+
+
+
+
+/*
+ * This function rebuilds the table with a new capacity, keeping only the live entries for which keep()
+ * returns true. Tombstones are always dropped. It returns the number of entries kept.
+ */
+static uint64_t cacheRebuild(Cache *cache, uint64_t capacity, int (*keep)(const CacheEntry *, time_t), time_t now) {
+    uint64_t oldCapacity = cache->header->capacity;
+    uint64_t live = 0;
+    CacheEntry *saved = malloc((size_t)(cache->header->live ? cache->header->live : 1) * sizeof(CacheEntry));
+    if (!saved)
+        return cache->header->live;
+    for (uint64_t i = 0; i < oldCapacity; i++) {
+        const CacheEntry *entry = &cache->entries[i];
+        if (entry->state == SLOT_LIVE && live < cache->header->live && (!keep || keep(entry, now)))
+            saved[live++] = *entry;
+    }
+
+    if (cacheFormat(cache, capacity) != 0) {
+        free(saved);
+        return 0;
+    }
+    for (uint64_t i = 0; i < live; i++) {
+        CacheEntry *entry = cacheFind(cache, saved[i].dev, saved[i].ino, saved[i].metrics);
+        if (entry)
+            *entry = saved[i];
+    }
+    cache->header->live = live;
+    free(saved);
+    return live;
+}
+
+
+
+
+
+Cache *cacheOpen(const char *path) {
+    if (!path)
+        return NULL;
+    Cache *cache = calloc(1, sizeof(*cache));
+    if (!cache)
+        return NULL;
+    cache->fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (cache->fd < 0 || flock(cache->fd, LOCK_EX | LOCK_NB) != 0) {
+        if (cache->fd >= 0)
+            close(cache->fd);
+        free(cache);
+        return NULL;
+    }
+
+    struct stat st;
+    CacheHeader header;
+    int valid = fstat(cache->fd, &st) == 0 &&
+        pread(cache->fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+        memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+        header.version == CACHE_VERSION &&
+        header.entrySize == sizeof(CacheEntry) &&
+        header.capacity && (header.capacity & (header.capacity - 1)) == 0 &&
+        header.live <= header.capacity && header.tombstones <= header.capacity - header.live &&
+        (uint64_t)st.st_size == sizeof(CacheHeader) + header.capacity * sizeof(CacheEntry);
+
+    int status = valid ? cacheMap(cache, header.capacity) : cacheFormat(cache, CACHE_INITIAL_CAPACITY);
+    if (status != 0) {
+        cacheClose(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+
+
+
+
+void cacheClose(Cache *cache) {
+    if (!cache)
+        return;
+    if (cache->header)
+        munmap(cache->header, cache->mappedSize);
+    close(cache->fd);
+    free(cache);
+}
+
+
+
+
+
+/*
+ * This function looks up the cached result for a file. It returns 1 and fills result on a hit, or 0
+ * when the file was never analyzed with this metric mask or has changed since.
+ */
+int cacheLookup(Cache *cache, const struct stat *st, unsigned metrics, clen_result *result) {
+    if (!cache->header)
+        return 0;
+    CacheEntry *entry = cacheFind(cache, (uint64_t)st->st_dev, (uint64_t)st->st_ino, metrics);
+    if (!entry || entry->state != SLOT_LIVE || entry->size != (uint64_t)st->st_size || entry->mtimeNs != mtimeNanos(st))
+        return 0;
+    entry->lastUsed = (uint64_t)time(NULL);
+    *result = entry->result;
+    return 1;
+}
+
+
+
+
+
+/*
+ * This function tells whether cacheLookup() would hit for a file, without counting it as a use. It
+ * lets --prefetch skip files the cache will answer without keeping their entries alive.
+ */
+int cacheContains(const Cache *cache, const struct stat *st, unsigned metrics) {
+    if (!cache->header)
+        return 0;
+    const CacheEntry *entry = cacheFind(cache, (uint64_t)st->st_dev, (uint64_t)st->st_ino, metrics);
+    return entry && entry->state == SLOT_LIVE && entry->size == (uint64_t)st->st_size && entry->mtimeNs == mtimeNanos(st);
+}
+
+
+
+
+
+/*
+ * This function stores the result for a file, replacing any older result for the same file and mask.
+ * Files modified within the last second are not stored: another write in that same second could
+ * leave the mtime unchanged and the cached result would silently go stale. A table without a free slot
+ * despite the load limit is corrupt and starts over empty.
+ */
+void cacheStore(Cache *cache, const struct stat *st, unsigned metrics, const clen_result *result) {
+    time_t now = time(NULL);
+    if (!cache->header || st->st_mtim.tv_sec >= now - 1)
+        return;
+
+    if ((cache->header->live + cache->header->tombstones + 1) * 10 > cache->header->capacity * 7)
+        cacheRebuild(cache, cache->header->capacity * 2, NULL, now);
+    if (!cache->header)
+        return;
+    CacheEntry *entry = cacheFind(cache, (uint64_t)st->st_dev, (uint64_t)st->st_ino, metrics);
+    if (!entry) {
+        if (cacheFormat(cache, CACHE_INITIAL_CAPACITY) != 0)
+            return;
+        entry = cacheFind(cache, (uint64_t)st->st_dev, (uint64_t)st->st_ino, metrics);
+    }
+    if (entry->state == SLOT_TOMBSTONE)
+        cache->header->tombstones--;
+    if (entry->state != SLOT_LIVE)
+        cache->header->live++;
+    entry->dev = (uint64_t)st->st_dev;
+    entry->ino = (uint64_t)st->st_ino;
+    entry->size = (uint64_t)st->st_size;
+    entry->mtimeNs = mtimeNanos(st);
+    entry->metrics = metrics;
+    entry->state = SLOT_LIVE;
+    entry->lastUsed = (uint64_t)now;
+    entry->result = *result;
+}
+
+
+
+
+
+/*
+ * This function drops every cached result for a file, whatever metric mask it was computed with.
+ */
+void cacheInvalidate(Cache *cache, const struct stat *st) {
+    if (!cache->header)
+        return;
+    for (unsigned metrics = 0; metrics <= CLEN_METRIC_ALL; metrics++) {
+        CacheEntry *entry = cacheFind(cache, (uint64_t)st->st_dev, (uint64_t)st->st_ino, metrics);
+        if (entry && entry->state == SLOT_LIVE) {
+            entry->state = SLOT_TOMBSTONE;
+            cache->header->live--;
+            cache->header->tombstones++;
+        }
+    }
+}
+
+
+
+
+
+void cacheClear(Cache *cache) {
+    cacheFormat(cache, CACHE_INITIAL_CAPACITY);
+}
+
+
+
+
+
+static int cacheRecentlyUsed(const CacheEntry *entry, time_t now) {
+    return entry->lastUsed + CACHE_STALE_DAYS * 86400ULL >= (uint64_t)now;
+}
+
+/*
+ * This function compacts the cache: results unused for CACHE_STALE_DAYS and all tombstones are dropped
+ * and the table is shrunk to the smallest power-of-two capacity that keeps it under 50% load.
+ * It returns the number of entries that remain.
+ */
+uint64_t cacheCompact(Cache *cache) {
+    if (!cache->header)
+        return 0;
+    time_t now = time(NULL);
+    uint64_t keep = 0;
+    for (uint64_t i = 0; i < cache->header->capacity; i++)
+        if (cache->entries[i].state == SLOT_LIVE && cacheRecentlyUsed(&cache->entries[i], now))
+            keep++;
+    uint64_t capacity = CACHE_INITIAL_CAPACITY;
+    while (capacity < keep * 2)
+        capacity *= 2;
+    return cacheRebuild(cache, capacity, cacheRecentlyUsed, now);
+}
@@ -0,0 +1,47 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef CLEN_CACHE_H
+#define CLEN_CACHE_H
+
+#include <stddef.h>
+#include <sys/stat.h>
+
+#include "clen.h"
+
+typedef struct Cache Cache;
+
+const char *cacheDefaultPath(char *buf, size_t size);
+Cache *cacheOpen(const char *path);
+void cacheClose(Cache *cache);
+int cacheLookup(Cache *cache, const struct stat *st, unsigned metrics, clen_result *result);
+int cacheContains(const Cache *cache, const struct stat *st, unsigned metrics);
+void cacheStore(Cache *cache, const struct stat *st, unsigned metrics, const clen_result *result);
+void cacheInvalidate(Cache *cache, const struct stat *st);
+void cacheClear(Cache *cache);
+uint64_t cacheCompact(Cache *cache);
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <string.h>
+
+#include "charclass.h"
+
+
+
+/*
+ * A class is written as NAME=SPEC, where SPEC lists the member bytes like a bracket expression without
+ * the brackets: single characters, ranges such as a-z, and the escapes \n, \t, \r, \\, \- and \xHH for
+ * arbitrary bytes. A '-' at the start or end of SPEC stands for itself, so "brackets=[](){}" and
+ * "signs=+-" need no escaping.
+ *
+ * Classes are not matched byte by byte. The byte histogram of the input is already collected in the
+ * same pass, so counting a class only sums the histogram over the bytes of its bitmap once per argument,
+ * and any number of classes costs the same per input byte as the built-in counters.
+ */
+
+
+
+
+
+/*
+ * This function reads one possibly escaped byte of a SPEC, advancing *p past it. Returns the byte, or
+ * -1 for a malformed escape.
+ */
+static int specByte(const char **p) {
+    const unsigned char *s = (const unsigned char *)*p;
+    if (*s != '\\') {
+        *p += 1;
+        return *s;
+    }
+    int byte;
+    switch (s[1]) {
+    case 'n':  byte = '\n'; break;
+    case 't':  byte = '\t'; break;
+    case 'r':  byte = '\r'; break;
+    case '\\': byte = '\\'; break;
+    case '-':  byte = '-'; break;
+    case 'x': {
+        byte = 0;
+        for (int i = 2; i < 4; i++) {
+            unsigned char c = s[i];
+            int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+            if (digit < 0)
+                return -1;
+            byte = byte * 16 + digit;
+        }
+        *p += 4;
+        return byte;
+    }
+    default:
+        return -1;
+    }
+    *p += 2;
+    return byte;
+}
+
+
+
+
+
+/*
+ * This function parses a NAME=SPEC definition. Returns 0 on success or -1 when the name is empty or too
+ * long, SPEC is empty, or it contains a malformed escape or a reversed range.
+ */
+int charClassParse(const char *definition, CharClass *charClass) {
+    const char *equals = strchr(definition, '=');
+    if (!equals || equals == definition || (size_t)(equals - definition) >= CHAR_CLASS_MAX_NAME || !equals[1])
+        return -1;
+    memset(charClass, 0, sizeof(*charClass));
+    memcpy(charClass->name, definition, (size_t)(equals - definition));
+
+    const char *p = equals + 1;
+    while (*p) {
+        int first = specByte(&p);
+        int last = first;
+        if (first < 0)
+            return -1;
+        if (p[0] == '-' && p[1]) {
+            p++;
+            last = specByte(&p);
+            if (last < first)
+                return -1;
+        }
+        for (int b = first; b <= last; b++)
+            charClass->bits[b >> 6] |= 1ULL << (b & 63);
+    }
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function tells whether a byte belongs to the class.
+ */
+int charClassHas(const CharClass *charClass, unsigned char byte) {
+    return (charClass->bits[byte >> 6] >> (byte & 63)) & 1;
+}
+
+
+
+
+
+/*
+ * This function returns how many bytes of the class a byte histogram holds.
+ */
+uint64_t charClassCount(const CharClass *charClass, const uint64_t histogram[256]) {
+    uint64_t count = 0;
+    for (int b = 0; b < 256; b++)
+        if (charClassHas(charClass, (unsigned char)b))
+            count += histogram[b];
+    return count;
+}
@@ -25,11 +25,51 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <unistd.h>
-#include <ctype.h>
 #include <stdlib.h>
 #include <time.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+#include "clen.h"
+#include "io.h"
+#include "serve.h"
+#include "cache.h"
+#include "follow.h"
+#include "blockindex.h"
+#include "dedupe.h"
+#include "pool.h"
+#include "cpu.h"
+#include "extras.h"
+#include "binary.h"
+#include "perline.h"
+#include "hll.h"
+#include "loglinear.h"
+
+
+
+/*
+ * Per-argument processing latencies are recorded into an HDR-style log-linear histogram (see
+ * loglinear.h). Every power-of-two range of nanoseconds is split into 2^LATENCY_SUB_BUCKET_BITS (128)
+ * linear sub-buckets, so each recorded value keeps a relative precision better than 1% while the whole
+ * table stays a fixed, allocation-free array no matter how many millions of arguments are processed.
+ */
+#define LATENCY_SUB_BUCKET_BITS 7
+#define LATENCY_BUCKETS         LOG_LINEAR_BUCKETS(LATENCY_SUB_BUCKET_BITS)
+
+/*
+ * Upper bound of the text of one result block, see formatResult().
+ */
+#define RESULT_TEXT_MAX 512
+
+typedef struct {
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+} LatencyHistogram;
 
 
 
@@ -66,13 +106,20 @@ size_t fastStrLen(const char *str) {
 
 
 /*
- * This function checks if the given string represents a valid file path on the system.
- * It uses the POSIX access() function with the F_OK flag to determine if the file or directory exists.
- * This check allows the program to decide whether to process the text itself or, when applicable,
- * to inspect the actual file content.
+ * This function writes the decimal digits of value to out and returns how many it wrote (at most 20).
+ * Result blocks are printed for every argument, and with --per-line for every line of a file, where
+ * parsing printf() formats would cost more than analyzing the line.
  */
-int isFilePath(const char *path) {
-    return access(path, F_OK) == 0;
+size_t formatNumber(char *out, uint64_t value) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (size_t i = 0; i < n; i++)
+        out[i] = digits[n - 1 - i];
+    return n;
 }
 
 
@@ -80,19 +127,18 @@ int isFilePath(const char *path) {
 
 
 /*
- * This function calculates the total size in bytes of the contents of a file.
- * It opens the file in binary mode, moves the file pointer to the end with fseek(),
- * and retrieves the position using ftell(), which gives the file size. The file is then closed.
- * This offers an efficient method for determining file content size when the argument is a valid file path.
+ * This function writes one metric line such as "    - 42 Letters" to out and returns its length.
  */
-size_t getFileContentLength(const char *path) {
-    FILE *file = fopen(path, "rb");
-    if (!file)
-        return 0;
-    fseek(file, 0, SEEK_END);
-    size_t size = ftell(file);
-    fclose(file);
-    return size;
+size_t formatMetric(char *out, const char *indent, uint64_t value, const char *label) {
+    size_t n = fastStrLen(indent);
+    memcpy(out, indent, n);
+    n += formatNumber(out + n, value);
+    out[n++] = ' ';
+    size_t labelLen = fastStrLen(label);
+    memcpy(out + n, label, labelLen);
+    n += labelLen;
+    out[n++] = '\n';
+    return n;
 }
 
 
@@ -100,16 +146,31 @@ size_t getFileContentLength(const char *path) {
 
 
 /*
- * This function counts the number of alphabetic letter characters (A-Z and a-z) in a string.
- * It iterates through each character in the string and uses the isalpha() function from ctype.h
- * to determine if the character is a letter, incrementing the count when it is.
+ * This function writes the metric lines of one result block to out, which must hold RESULT_TEXT_MAX
+ * bytes, and returns their length: the length followed by every metric that was requested, each on its
+ * own indented line.
  */
-int countLetters(const char *str) {
-    int count = 0;
-    while (*str)
-        if (isalpha(*str++))
-            count++;
-    return count;
+size_t formatResult(char *out, const clen_result *result, unsigned metrics, int countBytesFlag) {
+    size_t n = formatMetric(out, "    - ", result->length, "(Length)");
+    if (metrics & CLEN_METRIC_LETTERS)
+        n += formatMetric(out + n, "    - ", result->letters, "Letters");
+    if (metrics & CLEN_METRIC_CASES) {
+        n += formatMetric(out + n, "        - ", result->upper, "Uppercase");
+        n += formatMetric(out + n, "        - ", result->lower, "Lowercase");
+    }
+    if (metrics & CLEN_METRIC_NUMBERS)
+        n += formatMetric(out + n, "    - ", result->numbers, "Numbers");
+    if (metrics & CLEN_METRIC_SENTENCES)
+        n += formatMetric(out + n, "    - ", result->sentences, "Sentences");
+    if (metrics & CLEN_METRIC_SPECIAL)
+        n += formatMetric(out + n, "    - ", result->special, "Special Signs");
+    if (metrics & CLEN_METRIC_WORDS)
+        n += formatMetric(out + n, "    - ", result->words, "Words");
+    if (countBytesFlag)
+        n += formatMetric(out + n, "    - ", result->length, "Bytes");
+    if (metrics & CLEN_METRIC_QUOTES)
+        n += formatMetric(out + n, "    - ", result->quotes, "Quotes");
+    return n;
 }
 
 
@@ -117,16 +178,12 @@ int countLetters(const char *str) {
 
 
 /*
- * This function counts the number of numeric digit characters (0-9) present in a string.
- * It checks each character using isdigit() and increments a counter for every numeric digit found,
- * allowing for a quick assessment of the numerical content within the argument.
+ * This function prints the metric lines of one result block. It is shared by the per-argument output
+ * and the corpus-wide totals so both always use the same layout.
  */
-int countNumbers(const char *str) {
-    int count = 0;
-    while (*str)
-        if (isdigit(*str++))
-            count++;
-    return count;
+void printResult(const clen_result *result, unsigned metrics, int countBytesFlag) {
+    char text[RESULT_TEXT_MAX];
+    fwrite(text, 1, formatResult(text, result, metrics, countBytesFlag), stdout);
 }
 
 
@@ -134,22 +191,68 @@ int countNumbers(const char *str) {
 
 
 /*
- * This function counts the number of sentences in a string.
- * A sentence is defined as a sequence ending with a period ('.'), question mark ('?'), or exclamation mark ('!').
- * Furthermore, if one of these punctuation marks is immediately followed by a single or double quote,
- * that quote is considered part of the same sentence-ending sequence.
+ * This function maps a latency in nanoseconds to its histogram bucket, with LATENCY_SUB_BUCKET_BITS
+ * linear sub-buckets per power of two (see logLinearIndex()).
  */
-int countSentences(const char *str) {
-    int count = 0;
-    while (*str) {
-        if (*str == '.' || *str == '?' || *str == '!') {
-            count++;
-            if (*(str + 1) == '\'' || *(str + 1) == '\"')
-                str++;
+int latencyBucketIndex(uint64_t value) {
+    return logLinearIndex(value, LATENCY_SUB_BUCKET_BITS);
+}
+
+
+
+
+
+/*
+ * This function returns the lowest and highest latency (in nanoseconds) that fall into a given bucket.
+ * It is the exact inverse of latencyBucketIndex() and is used when reporting percentiles and when
+ * dumping the full histogram.
+ */
+void latencyBucketRange(int index, uint64_t *low, uint64_t *high) {
+    logLinearRange(index, LATENCY_SUB_BUCKET_BITS, low, high);
+}
+
+
+
+
+
+/*
+ * This function records a single latency value into the histogram, keeping track of the total number
+ * of samples as well as the exact minimum and maximum so the reported extremes are never rounded.
+ */
+void recordLatency(LatencyHistogram *hist, uint64_t nanoseconds) {
+    hist->counts[latencyBucketIndex(nanoseconds)]++;
+    if (hist->total == 0 || nanoseconds < hist->min)
+        hist->min = nanoseconds;
+    if (nanoseconds > hist->max)
+        hist->max = nanoseconds;
+    hist->total++;
+}
+
+
+
+
+
+/*
+ * This function returns the latency at the given percentile (0-100). It walks the buckets until the
+ * cumulative count reaches the requested rank and reports the highest value equivalent to that bucket,
+ * clamped to the exact maximum, which matches how HDR histograms report percentiles.
+ */
+uint64_t latencyPercentile(const LatencyHistogram *hist, double percentile) {
+    if (hist->total == 0)
+        return 0;
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)hist->total + 0.5);
+    if (rank < 1)
+        rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            uint64_t low, high;
+            latencyBucketRange(i, &low, &high);
+            return high < hist->max ? high : hist->max;
         }
-        str++;
     }
-    return count;
+    return hist->max;
 }
 
 
@@ -157,20 +260,37 @@ int countSentences(const char *str) {
 
 
 /*
- * This function counts the number of special characters in the string.
- * It uses a predefined list of special symbols (such as !, @, #, $, etc.) and iterates through
- * the string, increasing the counter whenever one of those symbols is found. This provides insight
- * into the non-alphanumeric composition of the text.
+ * This function prints the latency summary collected over all processed arguments: the common
+ * percentiles p50, p90, p99 and p99.9 together with the exact maximum. When dumpBuckets is set,
+ * every non-empty bucket is printed as well, with its value range, sample count and cumulative share,
+ * so the complete distribution can be inspected without any post-processing.
  */
-int countSpecialSigns(const char *str) {
-    int count = 0;
-    const char *special = "!@#$%^&*()-_=+[]{}|;:'\",.<>?/\\~`";
-    while (*str) {
-        if (strchr(special, *str))
-            count++;
-        str++;
+void printLatencySummary(const LatencyHistogram *hist, int dumpBuckets) {
+    printf("Latency (%llu %s)\n", (unsigned long long)hist->total, hist->total == 1 ? "Argument" : "Arguments");
+    printf("    - %.8fs p50\n", latencyPercentile(hist, 50.0) / 1e9);
+    printf("    - %.8fs p90\n", latencyPercentile(hist, 90.0) / 1e9);
+    printf("    - %.8fs p99\n", latencyPercentile(hist, 99.0) / 1e9);
+    printf("    - %.8fs p99.9\n", latencyPercentile(hist, 99.9) / 1e9);
+    printf("    - %.8fs Max\n", hist->max / 1e9);
+
+    if (dumpBuckets && hist->total) {
+        uint64_t seen = 0;
+        printf("\nLatency Histogram\n");
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            if (!hist->counts[i])
+                continue;
+            uint64_t low, high;
+            latencyBucketRange(i, &low, &high);
+            seen += hist->counts[i];
+            printf("    - [%.8fs, %.8fs] %llu (%.3f%%)\n",
+                low / 1e9,
+                high / 1e9,
+                (unsigned long long)hist->counts[i],
+                100.0 * (double)seen / (double)hist->total
+            );
+        }
     }
-    return count;
+    printf("\n");
 }
 
 
@@ -178,25 +298,132 @@ int countSpecialSigns(const char *str) {
 
 
 /*
- * This function counts the number of words in a string.
- * A word is defined as a continuous sequence of non-whitespace characters.
- * The function keeps track of transitions from whitespace to a non-whitespace character,
- * incrementing the word count each time a new word is detected.
+ * Everything that decides how a file argument is analyzed: the metric mask and the optional result
+ * cache, block index and dedupe table, plus the dedupe statistics reported at the end of the run:
+ * skippedBytes for duplicates never read, identicalBytes for copies recognized while reading them.
+ * After each file, source names where its result came from ("cache", "index", "dedupe", or NULL when
+ * the file was read) and io describes the read, for --profile. extras holds the additional analyses,
+ * which need every byte of every file. binaryPolicy decides what happens to files whose first
+ * binarySample bytes look binary; binary is set for such a file and binaries and binaryBytes add them up.
+ * With --per-line, perLine reports every line of each file as it is read.
  */
-int countWords(const char *str) {
-    int count = 0, inWord = 0;
-    while (*str) {
-        if (!isspace(*str)) {
-            if (!inWord) {
-                count++;
-                inWord = 1;
-            }
-        } else {
-            inWord = 0;
+typedef struct {
+    unsigned metrics;
+    Cache *cache;
+    int cacheInvalidate;
+    int blockIndex;
+    uint64_t blockSize;
+    DedupeTable *dedupe;
+    uint64_t duplicates;
+    uint64_t skippedBytes;
+    uint64_t identicalBytes;
+    const char *source;
+    IoProfile io;
+    Extras *extras;
+    BinaryPolicy binaryPolicy;
+    uint64_t binarySample;
+    int binary;
+    uint64_t binaries;
+    uint64_t binaryBytes;
+    PerLine *perLine;
+} FileAnalysis;
+
+
+
+
+
+/*
+ * This function produces the result for one file argument, trying the cheapest source first:
+ *   1. with --dedupe, a file already seen under the same device and inode (a hardlink or repeated
+ *      argument) reuses that result without touching the file;
+ *   2. the persistent cache answers for unchanged files;
+ *   3. with --dedupe, every other file is hashed in the same pass that analyzes it, and counts as a
+ *      duplicate when an earlier file had the same size and hash (its bytes were still read);
+ *   4. otherwise the file is analyzed, through its block index for large files with --block-index.
+ * Additional analyses such as --top-words, and --per-line, have to see the content itself, so with
+ * them every file is read and analyzed directly, feeding all of them in the same pass.
+ * Unless binary files are analyzed like any other, a regular file is first sampled, and a binary one
+ * only gets its size from stat() as its length before any of the above.
+ * It sets *duplicate when the result was taken from an earlier argument, and returns 0 on success or
+ * -1 if the file could not be read.
+ */
+int analyzeFileArgument(const char *path, FileAnalysis *analysis, clen_ctx *ctx, clen_result *result, int *duplicate) {
+    struct stat st;
+    int isRegular = stat(path, &st) == 0 && S_ISREG(st.st_mode);
+    int cacheable = analysis->cache && isRegular;
+    DedupeTable *dedupe = isRegular && analysis->metrics ? analysis->dedupe : NULL;
+    const clen_result *known = NULL;
+    *duplicate = 0;
+    analysis->source = NULL;
+    analysis->io = (IoProfile){ IO_READ, -1, 0, 0, 0 };
+    analysis->binary = 0;
+
+    if (analysis->binaryPolicy != BINARY_ANALYZE && isRegular && binarySniffFile(path, analysis->binarySample) == 1) {
+        *result = (clen_result){0};
+        result->length = (uint64_t)st.st_size;
+        analysis->binary = 1;
+        analysis->binaries++;
+        analysis->binaryBytes += (uint64_t)st.st_size;
+        analysis->source = "binary";
+        return 0;
+    }
+
+    if (analysis->extras || analysis->perLine) {
+        IoSink sink = { ctx, NULL, extrasFeed, analysis->extras };
+        if (analysis->perLine) {
+            sink.tap = perLineFeed;
+            sink.user = analysis->perLine;
         }
-        str++;
+        clen_reset(ctx);
+        int status = readFileContent(path, &sink, &analysis->io);
+        clen_finish(ctx, result);
+        if (analysis->perLine)
+            perLineFinish(analysis->perLine);
+        return status;
     }
-    return count;
+
+    if (dedupe && (known = dedupeFindInode(dedupe, (uint64_t)st.st_dev, (uint64_t)st.st_ino))) {
+        *result = *known;
+        *duplicate = 1;
+        analysis->duplicates++;
+        analysis->source = "dedupe";
+        analysis->skippedBytes += (uint64_t)st.st_size;
+        return 0;
+    }
+
+    if (cacheable && analysis->cacheInvalidate)
+        cacheInvalidate(analysis->cache, &st);
+    if (cacheable && cacheLookup(analysis->cache, &st, analysis->metrics, result)) {
+        analysis->source = "cache";
+        if (dedupe)
+            dedupeAdd(dedupe, (uint64_t)st.st_dev, (uint64_t)st.st_ino, (uint64_t)st.st_size, 0, 0, result);
+        return 0;
+    }
+
+    int status;
+    int hashed = 0;
+    uint64_t hash = 0;
+    int useIndex = analysis->blockIndex && analysis->metrics && isRegular && (uint64_t)st.st_size > analysis->blockSize;
+    if (dedupe && !useIndex) {
+        status = analyzeFileHashed(path, ctx, result, &hash, &analysis->io);
+        hashed = status == 0;
+        if (hashed && dedupeFindContent(dedupe, (uint64_t)st.st_size, hash)) {
+            *duplicate = 1;
+            analysis->duplicates++;
+            analysis->identicalBytes += (uint64_t)st.st_size;
+        }
+    } else if (useIndex) {
+        analysis->source = "index";
+        status = analyzeFileIndexed(path, ctx, result, analysis->blockSize);
+    } else {
+        status = analyzeFile(path, ctx, result, &analysis->io);
+    }
+
+    if (status == 0 && cacheable)
+        cacheStore(analysis->cache, &st, analysis->metrics, result);
+    if (status == 0 && dedupe)
+        dedupeAdd(dedupe, (uint64_t)st.st_dev, (uint64_t)st.st_ino, (uint64_t)st.st_size, hashed, hash, result);
+    return status;
 }
 
 
@@ -204,25 +431,204 @@ int countWords(const char *str) {
 
 
 /*
- * This function counts the number of quoted substrings in the string.
- * A quoted substring is defined as a segment of text that starts and ends with the same quote character
- * (either a double quote (") or a single quote (')). The function searches for a starting quote and then
- * looks for the corresponding closing quote, counting each complete pair.
+ * The --prefetch window: while argument current is analyzed, the next depth file arguments are already
+ * being read into the page cache, as long as the prefetched but not yet analyzed bytes stay within
+ * budget. Files the result cache or dedupe table will answer without reading are not prefetched. Binary
+ * files are not sniffed here, which would put their reads on the critical path; prefetching one that
+ * will not be analyzed only costs some readahead.
+ * requested[i] remembers how much was prefetched for argument i, which is released from pending once
+ * that argument is reached. With --max-read-rate or --max-iops there is no window: the readahead runs
+ * inside the kernel, where the token buckets cannot charge it.
  */
-int countQuotes(const char *str) {
-    int count = 0;
-    while (*str) {
-        if (*str == '\"' || *str == '\'') {
-            char quote = *str;
-            const char *temp = str + 1;
-            while (*temp && *temp != quote)
-                temp++;
-            if (*temp == quote) {
-                count++;
-                str = temp; // Skip to the closing quote
-            }
+typedef struct {
+    int depth;
+    uint64_t budget;
+    uint64_t pending;
+    int next;
+    uint64_t *requested;
+} PrefetchWindow;
+
+
+
+
+
+/*
+ * This function moves the prefetch window to argument current (an index into argv) and issues
+ * read-ahead for the arguments that entered it.
+ */
+void prefetchAhead(PrefetchWindow *window, const FileAnalysis *analysis, char *argv[], int argc, int firstArgIndex, int current) {
+    window->pending -= window->requested[current - firstArgIndex];
+    window->requested[current - firstArgIndex] = 0;
+    if (window->next <= current)
+        window->next = current + 1;
+
+    while (window->next < argc && window->next <= current + window->depth && window->pending < window->budget) {
+        const char *path = argv[window->next];
+        struct stat st;
+        int answered = stat(path, &st) != 0 || !S_ISREG(st.st_mode)
+            || (analysis->cache && !analysis->extras && !analysis->perLine && cacheContains(analysis->cache, &st, analysis->metrics))
+            || (analysis->dedupe && dedupeFindInode(analysis->dedupe, (uint64_t)st.st_dev, (uint64_t)st.st_ino));
+        if (!answered) {
+            uint64_t bytes = ioPrefetch(path, window->budget - window->pending);
+            window->requested[window->next - firstArgIndex] = bytes;
+            window->pending += bytes;
         }
-        str++;
+        window->next++;
+    }
+}
+
+
+
+
+
+/*
+ * This function prints the --profile line of a file argument: the cache, index or earlier duplicate
+ * that supplied the result, or else the I/O strategy that read the file, how many bytes it read,
+ * when auto mode sampled it, which share of the file was already in the page cache, and whether
+ * --direct-io had to fall back to dropping the file from the page cache (and, with --huge-pages, how
+ * much of a mapped file ended up in huge pages).
+ */
+void printProfile(const FileAnalysis *analysis) {
+    if (analysis->source) {
+        printf("    - Profile: %s\n", analysis->source);
+        return;
+    }
+    const IoProfile *io = &analysis->io;
+    printf("    - Profile: %s (%" PRIu64 " Bytes read", ioStrategyNames[io->strategy], io->bytesRead);
+    if (io->residentPercent >= 0)
+        printf(", %d%% Cached", io->residentPercent);
+    if (io->dropBehind)
+        printf(", Dropped from page cache");
+    if (io->hugeBytes)
+        printf(", %" PRIu64 " KiB in huge pages", io->hugeBytes / 1024);
+    printf(")\n");
+}
+
+
+
+
+
+/*
+ * This function prints how the buffer pool was used (its budget, the buffers allocated and at most in
+ * use at once, how often a reader waited for one, and the other buffers reserved against the budget)
+ * together with the peak resident set size of the process as reported by getrusage(). With
+ * --huge-pages it also shows how many huge pages were mapped or advised, and how much anonymous memory
+ * the kernel really backed with transparent huge pages.
+ */
+void printMemorySummary(int hugePages) {
+    PoolStats stats;
+    struct rusage usage;
+    poolGetStats(&stats);
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("Memory\n");
+    if (stats.limitBuffers)
+        printf("    - %" PRIu64 " KiB Buffer budget\n", stats.limitBuffers * (POOL_BUFFER_SIZE / 1024));
+    printf("    - %" PRIu64 " Buffers allocated (%" PRIu64 " in use at most)\n", stats.allocated, stats.peakInUse);
+    printf("    - %" PRIu64 " Waits for a buffer\n", stats.waits);
+    printf("    - %" PRIu64 " KiB Other buffers at most (%" PRIu64 " refused)\n", (stats.peakReserved + 1023) / 1024, stats.refused);
+    if (hugePages) {
+        printf("    - %" PRIu64 " Huge pages reserved (MAP_HUGETLB)\n", stats.hugetlbPages);
+        printf("    - %" PRIu64 " Huge pages advised (THP, %" PRIu64 " KiB obtained)\n", stats.transparentPages, poolSmapsBytes("AnonHugePages") / 1024);
+    }
+    printf("    - %ld KiB Peak RSS\n\n", usage.ru_maxrss);
+}
+
+
+
+
+
+/*
+ * Everything the follow-mode report needs to print an update in the usual result layout.
+ */
+typedef struct {
+    const char *path;
+    unsigned metrics;
+    int countBytesFlag;
+} FollowOutput;
+
+/*
+ * This function prints one follow-mode update: what happened to the file, how many new bytes were
+ * analyzed, and the running totals over everything read from it so far.
+ */
+void printFollowUpdate(const clen_result *totals, uint64_t newBytes, const char *event, void *user) {
+    const FollowOutput *output = user;
+    printf("%s (Following) +%" PRIu64 " Bytes %s\n", output->path, newBytes, event);
+    printResult(totals, output->metrics, output->countBytesFlag);
+    printf("\n");
+    fflush(stdout);
+}
+
+
+
+
+
+/*
+ * Everything the --per-line report needs to print a line of a file argument in the usual result layout.
+ */
+typedef struct {
+    int argument;
+    unsigned metrics;
+    int countBytesFlag;
+} PerLineOutput;
+
+/*
+ * This function prints the result of one line, numbered after the argument it belongs to, as a single
+ * write.
+ */
+void printLineResult(void *user, uint64_t number, const char *preview, size_t previewLen, const clen_result *result) {
+    const PerLineOutput *output = user;
+    char text[64 + PER_LINE_PREVIEW + RESULT_TEXT_MAX];
+    size_t n = formatNumber(text, (uint64_t)output->argument);
+    text[n++] = ':';
+    n += formatNumber(text + n, number);
+    memcpy(text + n, " -> ", 4);
+    n += 4;
+    memcpy(text + n, preview, previewLen);
+    n += previewLen;
+    if (result->length > previewLen) {
+        memcpy(text + n, "...", 3);
+        n += 3;
+    }
+    memcpy(text + n, " (Line)\n", 8);
+    n += 8;
+    n += formatResult(text + n, result, output->metrics, output->countBytesFlag);
+    text[n++] = '\n';
+    fwrite(text, 1, n, stdout);
+}
+
+
+
+
+
+/*
+ * This function returns the value that follows an option taking an argument (such as --serve PATH)
+ * and advances the parse index past it. A missing value is reported and terminates the program.
+ */
+const char *optionValue(int argc, char *argv[], int *index) {
+    if (*index + 1 >= argc) {
+        fprintf(stderr, "Missing value for option: %s\n", argv[*index]);
+        exit(1);
+    }
+    return argv[++*index];
+}
+
+
+
+
+
+/*
+ * This function reads the positive whole number that follows an option such as --threads N.
+ * Anything that is not a number greater than zero is reported and terminates the program.
+ */
+long optionCount(int argc, char *argv[], int *index) {
+    const char *option = argv[*index];
+    const char *value = optionValue(argc, argv, index);
+    char *end;
+    long count = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || count < 1) {
+        fprintf(stderr, "Invalid value for %s: %s\n", option, value);
+        exit(1);
     }
     return count;
 }
@@ -230,24 +636,30 @@ int countQuotes(const char *str) {
 
 
 
+
 /*
- * This function calculates the number of uppercase and lowercase letters in a given string.
- * It takes a pointer to the input string and two integer pointers for storing the count of uppercase
- * and lowercase characters. The function iterates over each character in the string and uses the 
- * standard C library functions isupper() and islower() to determine the case of alphabetic characters.
- * If a character is uppercase (A–Z), the uppercase counter is incremented; if it's lowercase (a–z),
- * the lowercase counter is incremented. This separation of case types allows users to analyze the
- * casing distribution within their input, which can be particularly useful for checking formatting,
- * analyzing data entry patterns, or enforcing style rules in text input.
+ * This function reads the byte size that follows an option such as --block-size SIZE. The number
+ * may carry a K, M or G suffix (powers of 1024). Anything else is reported and terminates the program.
  */
-void countCases(const char *str, int *upper, int *lower) {
-    *upper = 0;
-    *lower = 0;
-    while (*str) {
-        if (isupper((unsigned char)*str)) (*upper)++;
-        else if (islower((unsigned char)*str)) (*lower)++;
-        str++;
+uint64_t optionSize(int argc, char *argv[], int *index) {
+    const char *option = argv[*index];
+    const char *value = optionValue(argc, argv, index);
+    char *end;
+    unsigned long long size = strtoull(value, &end, 10);
+    int shift = 0;
+    if (*end == 'K' || *end == 'k')
+        shift = 10;
+    else if (*end == 'M' || *end == 'm')
+        shift = 20;
+    else if (*end == 'G' || *end == 'g')
+        shift = 30;
+    if (shift)
+        end++;
+    if (*value < '0' || *value > '9' || *end != '\0' || size == 0 || size > (UINT64_MAX >> shift)) {
+        fprintf(stderr, "Invalid value for %s: %s\n", option, value);
+        exit(1);
     }
+    return (uint64_t)size << shift;
 }
 
 
@@ -279,6 +691,54 @@ void showHelp() {
     printf("  --count-words          Count the number of words in the argument\n");
     printf("  --count-bytes          Count the number of bytes in the argument or file content\n");
     printf("  --count-quotes         Count quoted segments delimited by ' or \"\n");
+    printf("  --total                Print corpus-wide totals of every metric after all arguments\n");
+    printf("  --summary-only         Only print the totals, skipping the per-argument output\n");
+    printf("  --latency              Print p50/p90/p99/p99.9/max processing latency after all arguments\n");
+    printf("  --latency-histogram    Like --latency, and also dump the full latency histogram\n");
+    printf("  --serve PATH           Run as a daemon answering analysis requests on the Unix socket PATH\n");
+    printf("  --client               Send the arguments to a running daemon, analyzing locally if none answers\n");
+    printf("  --socket PATH          Daemon socket used by --client (default: %s)\n", SERVE_DEFAULT_SOCKET);
+    printf("  --threads N            Number of daemon worker threads (default: usable CPUs, see --verbose)\n");
+    printf("  --pin-threads          Pin each daemon worker thread to its own CPU\n");
+    printf("  --verbose              Explain how the daemon worker count was chosen\n");
+    printf("  --no-cache             Do not use the persistent result cache for file content\n");
+    printf("  --cache-file PATH      Result cache location (default: ~/.cache/clen/results.cache)\n");
+    printf("  --cache-invalidate     Drop cached results for the given files and analyze them again\n");
+    printf("  --cache-clear          Remove every cached result\n");
+    printf("  --cache-compact        Drop results unused for 30 days and shrink the cache file\n");
+    printf("  --follow FILE          Follow a growing file like tail -F, analyzing only appended bytes\n");
+    printf("  --follow-interval MS   How often --follow checks the file without inotify (default: 1000)\n");
+    printf("  --block-index          Keep a FILE.clenidx block index so only changed blocks of large files are re-analyzed\n");
+    printf("  --block-size SIZE      Block size of --block-index, with optional K/M/G suffix (default: 1M)\n");
+    printf("  --dedupe               Reuse results for hardlinked or identical files instead of analyzing them again\n");
+    printf("  --io MODE              How file content is read: auto, read, mmap or direct (default: auto)\n");
+    printf("  --direct-io            Read files with O_DIRECT, bypassing the page cache (same as --io direct)\n");
+    printf("  --prefetch K           Read the next K file arguments into the page cache while analyzing the current one (off with --max-read-rate or --max-iops)\n");
+    printf("  --prefetch-budget SIZE Most bytes --prefetch reads ahead at once, with optional K/M/G suffix (default: 64M)\n");
+    printf("  --max-read-rate SIZE   Read files at most SIZE bytes per second, with optional K/M/G suffix\n");
+    printf("  --max-iops N           Issue at most N file reads per second\n");
+    printf("  --idle                 Run with idle I/O priority and SCHED_IDLE so other processes always go first\n");
+    printf("  --max-memory SIZE      Budget for I/O, daemon request and sample buffers, with optional K/M/G suffix; readers wait instead of allocating more\n");
+    printf("  --huge-pages           Back I/O buffers and mapped files with huge pages where the system allows it\n");
+    printf("  --count-pattern LIT    Count the occurrences of the literal LIT (repeatable), per argument and overall\n");
+    printf("  --patterns-file FILE   Count the occurrences of every line of FILE as a literal, like --count-pattern\n");
+    printf("  --count-class NAME=SPEC  Count the bytes in SPEC, e.g. brackets=[](){} or hex=0-9a-fA-F (repeatable)\n");
+    printf("  --count-regex RE       Count the lines matching the extended regular expression RE (repeatable), like grep -c\n");
+    printf("  --regex-cache SIZE     Memory for the lazily built DFA of each --count-regex (default: %uK)\n", REGEXP_DEFAULT_CACHE / 1024);
+    printf("  --length-stats         Report min, mean, p50/p90/p99 and max of line and word lengths, per argument and overall\n");
+    printf("  --binary POLICY        What to do with binary files: analyze (default), size (report only their size) or skip\n");
+    printf("  --binary-sample SIZE   How much of the start of a file decides whether it is binary (default: %uK)\n", BINARY_DEFAULT_SAMPLE / 1024);
+    printf("  --per-line             With --count-filecontent, also report every line of each file on its own (not with --summary-only)\n");
+    printf("  --profile              Show where each file result came from and how the file was read\n");
+    printf("  --top-words K          Print the K most frequent words across all arguments\n");
+    printf("  --top-words-memory SIZE  Memory for --top-words before exact counts turn into bounded estimates\n");
+    printf("  --count-distinct-words Estimate the number of distinct words (HyperLogLog) per argument and overall\n");
+    printf("  --count-distinct-lines Estimate the number of distinct lines (HyperLogLog) per argument and overall\n");
+    printf("  --distinct-precision P Precision of the distinct estimates, %d-%d (default: %d, about 0.8%% error)\n", HLL_MIN_PRECISION, HLL_MAX_PRECISION, HLL_DEFAULT_PRECISION);
+    printf("  --distinct-save FILE   Save the overall distinct sketches so other runs can merge them (requires --count-distinct-*)\n");
+    printf("  --distinct-merge FILE  Merge distinct sketches saved by another run into the overall estimate (requires --count-distinct-*)\n");
+    printf("  --byte-histogram       Print how often each byte value occurs per argument and overall\n");
+    printf("  --entropy              Print the Shannon entropy of the bytes in bits per byte\n");
     printf("  --help                 Show this help message\n\n");
 }
 
@@ -315,7 +775,47 @@ int main(int argc, char *argv[]) {
     int countWordsFlag       = 0;
     int countBytesFlag       = 0;
     int countQuotesFlag      = 0;
+    int totalFlag            = 0;
+    int summaryOnlyFlag      = 0;
+    int latencyFlag          = 0;
+    int latencyDumpFlag      = 0;
+    int clientFlag           = 0;
+    int threads              = 0;
+    int pinThreadsFlag       = 0;
+    int verboseFlag          = 0;
+    const char *serveSocket  = NULL;
+    const char *socketPath   = SERVE_DEFAULT_SOCKET;
+    int noCacheFlag          = 0;
+    int cacheInvalidateFlag  = 0;
+    int cacheClearFlag       = 0;
+    int cacheCompactFlag     = 0;
+    const char *cachePath    = NULL;
+    const char *followPath   = NULL;
+    long followIntervalMs    = 1000;
+    int blockIndexFlag       = 0;
+    uint64_t blockSize       = BLOCK_INDEX_DEFAULT_BLOCK;
+    int dedupeFlag           = 0;
+    IoOptions ioOptions      = { IO_AUTO, 0, 0, 0 };
+    int idleFlag             = 0;
+    ExtrasOptions extrasOptions = { .distinctPrecision = HLL_DEFAULT_PRECISION, .regexCache = REGEXP_DEFAULT_CACHE };
+    const char *distinctSave = NULL;
+    Patterns *patterns       = NULL;
+    CharClass *classes       = calloc((size_t)argc, sizeof(CharClass));
+    Regexp **regexes         = calloc((size_t)argc, sizeof(Regexp *));
+    BinaryPolicy binaryPolicy = BINARY_ANALYZE;
+    uint64_t binarySample    = BINARY_DEFAULT_SAMPLE;
+    const char **distinctMerges = calloc((size_t)argc, sizeof(char *));
+    int distinctMergeCount   = 0;
+    int prefetchDepth        = 0;
+    uint64_t prefetchBudget  = 64ULL << 20;
+    uint64_t maxMemory       = 0;
+    int profileFlag          = 0;
+    int perLineFlag          = 0;
     int firstArgIndex        = 1;
+    if (!classes || !regexes || !distinctMerges) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
 
 
 
@@ -348,6 +848,133 @@ int main(int argc, char *argv[]) {
             countBytesFlag = 1;
         else if (strcmp(arg, "--count-quotes") == 0)
             countQuotesFlag = 1;
+        else if (strcmp(arg, "--total") == 0)
+            totalFlag = 1;
+        else if (strcmp(arg, "--summary-only") == 0)
+            totalFlag = summaryOnlyFlag = 1;
+        else if (strcmp(arg, "--latency") == 0)
+            latencyFlag = 1;
+        else if (strcmp(arg, "--latency-histogram") == 0)
+            latencyFlag = latencyDumpFlag = 1;
+        else if (strcmp(arg, "--serve") == 0)
+            serveSocket = optionValue(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--client") == 0)
+            clientFlag = 1;
+        else if (strcmp(arg, "--socket") == 0)
+            socketPath = optionValue(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--threads") == 0)
+            threads = (int)optionCount(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--pin-threads") == 0)
+            pinThreadsFlag = 1;
+        else if (strcmp(arg, "--verbose") == 0)
+            verboseFlag = 1;
+        else if (strcmp(arg, "--no-cache") == 0)
+            noCacheFlag = 1;
+        else if (strcmp(arg, "--cache-file") == 0)
+            cachePath = optionValue(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--cache-invalidate") == 0)
+            cacheInvalidateFlag = 1;
+        else if (strcmp(arg, "--cache-clear") == 0)
+            cacheClearFlag = 1;
+        else if (strcmp(arg, "--cache-compact") == 0)
+            cacheCompactFlag = 1;
+        else if (strcmp(arg, "--follow") == 0)
+            followPath = optionValue(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--follow-interval") == 0)
+            followIntervalMs = optionCount(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--block-index") == 0)
+            blockIndexFlag = 1;
+        else if (strcmp(arg, "--block-size") == 0)
+            blockSize = optionSize(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--dedupe") == 0)
+            dedupeFlag = 1;
+        else if (strcmp(arg, "--io") == 0) {
+            const char *value = optionValue(argc, argv, &firstArgIndex);
+            if (ioParseStrategy(value, &ioOptions.strategy) != 0) {
+                fprintf(stderr, "Invalid value for --io: %s\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--direct-io") == 0)
+            ioOptions.strategy = IO_DIRECT;
+        else if (strcmp(arg, "--prefetch") == 0)
+            prefetchDepth = (int)optionCount(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--prefetch-budget") == 0)
+            prefetchBudget = optionSize(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--huge-pages") == 0)
+            ioOptions.hugePages = 1;
+        else if (strcmp(arg, "--max-read-rate") == 0)
+            ioOptions.maxReadRate = optionSize(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--max-iops") == 0)
+            ioOptions.maxIops = (uint64_t)optionCount(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--idle") == 0)
+            idleFlag = 1;
+        else if (strcmp(arg, "--max-memory") == 0)
+            maxMemory = optionSize(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--top-words") == 0)
+            extrasOptions.topWords = (size_t)optionCount(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--top-words-memory") == 0)
+            extrasOptions.topWordsMemory = optionSize(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--count-distinct-words") == 0)
+            extrasOptions.distinctWords = 1;
+        else if (strcmp(arg, "--count-distinct-lines") == 0)
+            extrasOptions.distinctLines = 1;
+        else if (strcmp(arg, "--distinct-precision") == 0) {
+            long precision = optionCount(argc, argv, &firstArgIndex);
+            if (precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION) {
+                fprintf(stderr, "Invalid value for --distinct-precision: %ld (allowed: %d-%d)\n", precision, HLL_MIN_PRECISION, HLL_MAX_PRECISION);
+                return 1;
+            }
+            extrasOptions.distinctPrecision = (unsigned)precision;
+        } else if (strcmp(arg, "--distinct-save") == 0)
+            distinctSave = optionValue(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--distinct-merge") == 0)
+            distinctMerges[distinctMergeCount++] = optionValue(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--byte-histogram") == 0)
+            extrasOptions.byteHistogram = 1;
+        else if (strcmp(arg, "--entropy") == 0)
+            extrasOptions.entropy = 1;
+        else if (strcmp(arg, "--count-pattern") == 0 || strcmp(arg, "--patterns-file") == 0) {
+            const char *value = optionValue(argc, argv, &firstArgIndex);
+            if (!patterns && !(patterns = patternsNew())) {
+                fprintf(stderr, "Out of memory\n");
+                return 1;
+            }
+            int status = strcmp(arg, "--count-pattern") == 0 ? patternsAdd(patterns, value, fastStrLen(value)) : patternsAddFile(patterns, value);
+            if (status != 0) {
+                fprintf(stderr, "Invalid value for %s: %s\n", arg, value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--count-class") == 0) {
+            const char *value = optionValue(argc, argv, &firstArgIndex);
+            if (charClassParse(value, &classes[extrasOptions.classCount]) != 0) {
+                fprintf(stderr, "Invalid value for --count-class: %s (expected NAME=SPEC)\n", value);
+                return 1;
+            }
+            extrasOptions.classCount++;
+        } else if (strcmp(arg, "--count-regex") == 0) {
+            const char *value = optionValue(argc, argv, &firstArgIndex);
+            const char *error;
+            if (!(regexes[extrasOptions.regexCount] = regexpCompile(value, &error))) {
+                fprintf(stderr, "Invalid value for --count-regex: %s (%s)\n", value, error);
+                return 1;
+            }
+            extrasOptions.regexCount++;
+        } else if (strcmp(arg, "--regex-cache") == 0)
+            extrasOptions.regexCache = optionSize(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--length-stats") == 0)
+            extrasOptions.lengthStats = 1;
+        else if (strcmp(arg, "--binary") == 0) {
+            const char *value = optionValue(argc, argv, &firstArgIndex);
+            if (binaryParsePolicy(value, &binaryPolicy) != 0) {
+                fprintf(stderr, "Invalid value for --binary: %s\n", value);
+                return 1;
+            }
+        } else if (strcmp(arg, "--binary-sample") == 0)
+            binarySample = optionSize(argc, argv, &firstArgIndex);
+        else if (strcmp(arg, "--per-line") == 0)
+            perLineFlag = 1;
+        else if (strcmp(arg, "--profile") == 0)
+            profileFlag = 1;
         else if (strcmp(arg, "--help") == 0 || strcmp(arg, "--h") == 0) {
             showHelp();
             return 0;
@@ -357,6 +984,111 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    // --> DISTINCT SKETCHES CAN ONLY BE SAVED OR MERGED WHEN SOME ARE COUNTED
+    if ((distinctSave || distinctMergeCount) && !extrasOptions.distinctWords && !extrasOptions.distinctLines) {
+        fprintf(stderr, "%s requires --count-distinct-words or --count-distinct-lines\n", distinctSave ? "--distinct-save" : "--distinct-merge");
+        return 1;
+    }
+
+    // --> PER-LINE RESULTS NEED FILE CONTENT AND THE PER-ARGUMENT OUTPUT
+    if (perLineFlag && (!countFileContentFlag || summaryOnlyFlag)) {
+        fprintf(stderr, "--per-line %s\n", summaryOnlyFlag ? "cannot be combined with --summary-only" : "requires --count-filecontent");
+        return 1;
+    }
+
+
+
+    // --> APPLY THE I/O STRATEGY, RATE LIMITS, MEMORY BUDGET AND PRIORITY, WHICH THE DAEMON USES AS WELL
+    ioSetOptions(&ioOptions);
+    poolConfigure(maxMemory, ioOptions.hugePages);
+    if (idleFlag && ioSetIdlePriority() != 0)
+        fprintf(stderr, "Could not switch to idle I/O and CPU priority\n");
+
+
+
+    /*
+     * The daemon runs one worker per CPU the process may actually use, which inside a container or
+     * under taskset is the affinity mask capped by the cgroup CPU quota rather than every CPU of the
+     * host. --threads overrides the choice, and --verbose shows how it was made.
+     */
+    if (serveSocket) {
+        CpuBudget cpus;
+        cpuGetBudget(&cpus);
+        if (verboseFlag) {
+            printf("CPUs: %d online, %d in affinity mask, ", cpus.online, cpus.affinity);
+            if (cpus.quota > 0)
+                printf("cgroup quota %.2f\n", cpus.quota);
+            else
+                printf("no cgroup quota\n");
+            printf("Workers: %d %s%s\n", threads ? threads : cpus.threads, threads ? "(set by --threads)" : "(from usable CPUs)",
+                pinThreadsFlag ? ", pinned to CPUs" : "");
+        }
+        return serveRun(serveSocket, threads ? threads : cpus.threads, pinThreadsFlag);
+    }
+
+
+
+    /*
+     * The metric flags are folded into the bitmask understood by the analyzer library. Case counting
+     * keeps its historic meaning of only being active together with --count-letters.
+     */
+    unsigned metrics = 0;
+    if (countLettersFlag)
+        metrics |= CLEN_METRIC_LETTERS;
+    if (countLettersFlag && countCasesFlag)
+        metrics |= CLEN_METRIC_CASES;
+    if (countNumbersFlag)
+        metrics |= CLEN_METRIC_NUMBERS;
+    if (countSentencesFlag)
+        metrics |= CLEN_METRIC_SENTENCES;
+    if (countSpecialFlag)
+        metrics |= CLEN_METRIC_SPECIAL;
+    if (countWordsFlag)
+        metrics |= CLEN_METRIC_WORDS;
+    if (countQuotesFlag)
+        metrics |= CLEN_METRIC_QUOTES;
+
+    // --> FOLLOW A GROWING FILE WHEN ASKED TO
+    if (followPath) {
+        FollowOutput output = { followPath, metrics, countBytesFlag };
+        return followFile(followPath, metrics, followIntervalMs, printFollowUpdate, &output);
+    }
+
+    // --> THE BYTE HISTOGRAM ALREADY YIELDS THE BYTE-CLASS COUNTERS, SO THE ANALYZER SKIPS THEM
+    unsigned analyzerMetrics = metrics & ~extrasDerivedMetrics(&extrasOptions);
+    clen_ctx *ctx = clen_new(analyzerMetrics);
+    if (!ctx) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+
+
+    /*
+     * File content results are kept in a persistent cache keyed by the file's identity, size and
+     * modification time, so unchanged files are not read again on the next run. The cache is only
+     * opened when file content is analyzed locally, or when one of the maintenance options asks for it.
+     */
+    Cache *cache = NULL;
+    int cacheMaintenance = cacheClearFlag || cacheCompactFlag;
+    if (!noCacheFlag && ((countFileContentFlag && metrics && !clientFlag) || cacheMaintenance)) {
+        char defaultPath[4096];
+        cache = cacheOpen(cachePath ? cachePath : cacheDefaultPath(defaultPath, sizeof(defaultPath)));
+        if (!cache && cacheMaintenance)
+            fprintf(stderr, "Could not open the result cache\n");
+    }
+    if (cache && cacheClearFlag) {
+        cacheClear(cache);
+        printf("Cache cleared\n\n");
+    }
+    if (cache && cacheCompactFlag)
+        printf("Cache compacted (%" PRIu64 " entries kept)\n\n", cacheCompact(cache));
+    if (cacheMaintenance && firstArgIndex == argc) {
+        cacheClose(cache);
+        clen_free(ctx);
+        return 0;
+    }
+
 
 
     /*
@@ -374,75 +1106,199 @@ int main(int argc, char *argv[]) {
 
     /*
      * In this loop, each argument (after the options) is processed one by one.
-     * For each argument, we record the processing start time, determine if the argument is a file,
-     * and choose to calculate the length either by reading the file content or by using our fast string length method.
-     * A short preview (first 8 characters plus "..." if needed) is then generated.
-     * After processing, the time taken is computed and displayed alongside the preview.
+     * For each argument, we record the processing start time and determine if the argument is a file.
+     * With --count-filecontent a file's content is streamed through the analyzer (or, when no metric
+     * beyond the length is requested, only its size is looked up); every other argument is analyzed as
+     * the text itself. A short preview (first 8 characters plus "..." if needed) is then generated.
+     * After processing, the time taken is computed and displayed alongside the preview, and it is also
+     * recorded into the latency histogram that backs the --latency summary.
+     * File arguments go through analyzeFileArgument(), which reuses cached, indexed or deduplicated
+     * results wherever it can. With --prefetch the following file arguments are read ahead meanwhile.
+     * With --client the whole batch is first handed to a running daemon and its results (and timings)
+     * are used instead; if no daemon answers, the arguments are analyzed locally as usual. Additional
+     * analyses such as --top-words always run locally, fed in the same pass as the analyzer.
+     * In --summary-only mode the preview and every per-argument line are skipped entirely; the metrics
+     * are still computed and folded into the 64-bit totals.
      */
+    static LatencyHistogram latency;
+    if (patterns && patternsCompile(patterns) != 0) {
+        fprintf(stderr, "Could not compile the patterns (too many or too long)\n");
+        return 1;
+    }
+    extrasOptions.patterns = patterns;
+    extrasOptions.classes = classes;
+    extrasOptions.regexes = regexes;
+    Extras *extras = NULL;
+    if (extrasRequested(&extrasOptions) && !(extras = extrasNew(&extrasOptions))) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    for (int i = 0; extras && i < distinctMergeCount; i++) {
+        if (extrasMergeDistinct(extras, distinctMerges[i]) != 0) {
+            fprintf(stderr, "Could not merge distinct sketches from %s (missing, damaged or another precision)\n", distinctMerges[i]);
+            return 1;
+        }
+    }
+    PerLineOutput perLineOutput = { 0, metrics, countBytesFlag };
+    PerLine perLine;
+    if (perLineFlag && perLineInit(&perLine, metrics, printLineResult, &perLineOutput) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    if (perLineFlag && extras) {
+        perLine.tap = extrasFeed;
+        perLine.tapUser = extras;
+    }
+    ServeReply *remote = NULL;
+    if (clientFlag && !extras && !perLineFlag && binaryPolicy == BINARY_ANALYZE)
+        remote = serveClientAnalyze(socketPath, metrics, countFileContentFlag, argv + firstArgIndex, numArgs);
+    FileAnalysis fileAnalysis = { metrics, cache, cacheInvalidateFlag, blockIndexFlag, blockSize, NULL, 0, 0, 0, NULL, { IO_READ, -1, 0, 0, 0 }, extras, binaryPolicy, binarySample, 0, 0, 0, perLineFlag ? &perLine : NULL };
+    if (dedupeFlag && countFileContentFlag && !remote && !extras && !perLineFlag)
+        fileAnalysis.dedupe = dedupeNew();
+    PrefetchWindow prefetch = { prefetchDepth, prefetchBudget, 0, 0, NULL };
+    if (prefetchDepth && countFileContentFlag && !remote && ioOptions.strategy != IO_DIRECT &&
+        !ioOptions.maxReadRate && !ioOptions.maxIops)
+        prefetch.requested = calloc((size_t)numArgs, sizeof(uint64_t));
+    clen_result totals = {0};
+    uint64_t totalArguments = 0;
     for (int i = firstArgIndex; i < argc; i++) {
         const char *arg = argv[i];
+        perLineOutput.argument = i - firstArgIndex + 1;
+        if (prefetch.requested)
+            prefetchAhead(&prefetch, &fileAnalysis, argv, argc, firstArgIndex, i);
+
         struct timespec start, end;
         clock_gettime(CLOCK_MONOTONIC, &start);
 
-        size_t length;
+        clen_result result;
+        int duplicate = 0;
         int isFile = isFilePath(arg);
-        if (isFile && countFileContentFlag)
-            length = getFileContentLength(arg);
-        else
-            length = fastStrLen(arg);
-            
+        if (remote) {
+            result = remote[i - firstArgIndex].result;
+            if (remote[i - firstArgIndex].status)
+                fprintf(stderr, "Could not read file: %s\n", arg);
+        } else if (isFile && countFileContentFlag) {
+            if (analyzeFileArgument(arg, &fileAnalysis, ctx, &result, &duplicate) != 0)
+                fprintf(stderr, "Could not read file: %s\n", arg);
+        } else {
+            clen_analyze(analyzerMetrics, arg, fastStrLen(arg), &result);
+            if (extras)
+                extrasFeed(extras, arg, fastStrLen(arg));
+        }
+        int binary = isFile && countFileContentFlag && !remote && fileAnalysis.binary;
+        if (extras) {
+            extrasEndInput(extras);
+            if (!binary)
+                extrasDeriveCounts(extras, metrics, &result);
+        }
 
         char preview[20];
-        if (fastStrLen(arg) > 8)
-            snprintf(preview, sizeof(preview), "%.8s...", arg);
-        else
-            snprintf(preview, sizeof(preview), "%s", arg);
+        if (!summaryOnlyFlag) {
+            if (fastStrLen(arg) > 8)
+                snprintf(preview, sizeof(preview), "%.8s...", arg);
+            else
+                snprintf(preview, sizeof(preview), "%s", arg);
+        }
 
         clock_gettime(CLOCK_MONOTONIC, &end);
-        double processTime = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        uint64_t processNanos = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL + (uint64_t)(end.tv_nsec - start.tv_nsec);
+        if (remote)
+            processNanos = remote[i - firstArgIndex].nanos;
+        double processTime = processNanos / 1e9;
+        recordLatency(&latency, processNanos);
+
+        if (totalFlag && !(binary && binaryPolicy == BINARY_SKIP)) {
+            totalArguments++;
+            clen_merge(&totals, &result);
+        }
 
+        if (summaryOnlyFlag)
+            continue;
 
-        // --> PRINT THE ARGUMENT INDEX, PREVIEW, AND PROCESSING TIME
-        printf("%d -> %s (%.8fs)%s\n",
+
+        // --> PRINT THE ARGUMENT INDEX, PREVIEW, PROCESSING TIME AND METRICS
+        printf("%d -> %s (%.8fs)%s%s%s\n",
             i - firstArgIndex + 1,
             preview,
             processTime,
-            isFile ? " (File)" : ""
+            isFile ? " (File)" : "",
+            duplicate ? " (Duplicate)" : "",
+            binary ? (binaryPolicy == BINARY_SKIP ? " (Binary, Skipped)" : " (Binary)") : ""
         );
-        printf("    - %zu (Length)\n", length);
-
-
-
-        /*
-         * Now we print additional counts for this argument based on the flags that were set earlier.
-         * Each requested metric (letters, numbers, sentences, special signs, words, bytes, quotes, and the uppercase version)
-         * is computed and printed on its own indented line.
-         */
-        if (countLettersFlag)
-            printf("    - %d Letters\n", countLetters(arg));
-        if (countLettersFlag && countCasesFlag) {
-            int upper = 0, lower = 0;
-            countCases(arg, &upper, &lower);
-            printf("        - %d Uppercase\n", upper);
-            printf("        - %d Lowercase\n", lower);
-        }
-        if (countNumbersFlag)
-            printf("    - %d Numbers\n", countNumbers(arg));
-        if (countSentencesFlag)
-            printf("    - %d Sentences\n", countSentences(arg));
-        if (countSpecialFlag)
-            printf("    - %d Special Signs\n", countSpecialSigns(arg));
-        if (countWordsFlag)
-            printf("    - %d Words\n", countWords(arg));
-        if (countBytesFlag)
-            printf("    - %zu Bytes\n", length);
-        if (countQuotesFlag)
-            printf("    - %d Quotes\n", countQuotes(arg));
+        if (!binary)
+            printResult(&result, metrics, countBytesFlag);
+        else if (binaryPolicy == BINARY_SIZE)
+            printResult(&result, 0, countBytesFlag);
+        if (extras && !binary)
+            extrasPrintInput(extras);
+        if (profileFlag && isFile && countFileContentFlag && !remote)
+            printProfile(&fileAnalysis);
 
         printf("\n");
         fflush(stdout);
     }
 
+
+
+    // --> PRINT THE CORPUS-WIDE TOTALS
+    if (totalFlag) {
+        printf("Total (%" PRIu64 " %s)\n", totalArguments, totalArguments == 1 ? "Argument" : "Arguments");
+        printResult(&totals, metrics, countBytesFlag);
+        printf("\n");
+    }
+
+
+
+    // --> PRINT THE RESULTS OF THE ADDITIONAL ANALYSES OVER THE WHOLE RUN
+    if (extras)
+        extrasPrintRun(extras);
+    if (extras && distinctSave && extrasSaveDistinct(extras, distinctSave) != 0)
+        fprintf(stderr, "Could not save distinct sketches to %s\n", distinctSave);
+
+
+
+    // --> PRINT HOW MUCH WORK DEDUPLICATION SAVED
+    if (fileAnalysis.dedupe) {
+        printf("Deduplicated (%" PRIu64 " %s)\n", fileAnalysis.duplicates, fileAnalysis.duplicates == 1 ? "Duplicate" : "Duplicates");
+        printf("    - %" PRIu64 " Bytes skipped\n", fileAnalysis.skippedBytes);
+        printf("    - %" PRIu64 " Bytes read in identical copies\n\n", fileAnalysis.identicalBytes);
+    }
+
+
+
+    // --> PRINT HOW MANY BINARY FILES WERE LEFT UNANALYZED
+    if (fileAnalysis.binaries) {
+        printf("Binary (%" PRIu64 " %s %s)\n", fileAnalysis.binaries, fileAnalysis.binaries == 1 ? "File" : "Files",
+            binaryPolicy == BINARY_SKIP ? "skipped" : "sized");
+        printf("    - %" PRIu64 " Bytes not analyzed\n\n", fileAnalysis.binaryBytes);
+    }
+
+
+
+    // --> PRINT THE LATENCY SUMMARY OVER ALL ARGUMENTS
+    if (latencyFlag)
+        printLatencySummary(&latency, latencyDumpFlag);
+
+
+
+    // --> PRINT THE BUFFER POOL USAGE AND PEAK MEMORY
+    if (maxMemory || profileFlag || ioOptions.hugePages)
+        printMemorySummary(ioOptions.hugePages);
+
+    free(remote);
+    free(prefetch.requested);
+    extrasFree(extras);
+    if (perLineFlag)
+        perLineFree(&perLine);
+    patternsFree(patterns);
+    free(classes);
+    for (size_t i = 0; regexes && i < extrasOptions.regexCount; i++)
+        regexpFree(regexes[i]);
+    free(regexes);
+    free(distinctMerges);
+    dedupeFree(fileAnalysis.dedupe);
+    cacheClose(cache);
+    clen_free(ctx);
     return 0;
 
 }
@@ -0,0 +1,172 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef CLEN_H
+#define CLEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+
+
+
+/*
+ * libclen is the analyzer behind the clen command-line tool, packaged so other programs can run the
+ * same text analysis in-process instead of spawning the binary. An analyzer context is created with a
+ * bitmask of the metrics it should compute, input is streamed into it with clen_feed() in chunks of any
+ * size (state such as an open word or an unterminated quote carries across chunk boundaries), and
+ * clen_finish() produces the results. The length is always counted.
+ *
+ * The metrics are defined exactly as the command-line tool defines them:
+ *   - letters:    alphabetic characters A-Z and a-z
+ *   - cases:      the letters split into uppercase and lowercase
+ *   - numbers:    digits 0-9
+ *   - sentences:  sentence endings '.', '?' or '!'
+ *   - special:    characters from the set !@#$%^&*()-_=+[]{}|;:'",.<>?/\~`
+ *   - words:      continuous sequences of non-whitespace characters
+ *   - quotes:     segments that start and end with the same quote character (' or ")
+ */
+#define CLEN_METRIC_LETTERS    (1u << 0)
+#define CLEN_METRIC_CASES      (1u << 1)
+#define CLEN_METRIC_NUMBERS    (1u << 2)
+#define CLEN_METRIC_SENTENCES  (1u << 3)
+#define CLEN_METRIC_SPECIAL    (1u << 4)
+#define CLEN_METRIC_WORDS      (1u << 5)
+#define CLEN_METRIC_QUOTES     (1u << 6)
+#define CLEN_METRIC_ALL        ((1u << 7) - 1)
+
+/*
+ * The metrics that only depend on how often each byte value occurs, and can therefore also be
+ * computed from a byte histogram with clen_from_histogram().
+ */
+#define CLEN_METRIC_BYTE_CLASSES (CLEN_METRIC_LETTERS | CLEN_METRIC_CASES | CLEN_METRIC_NUMBERS | \
+                                  CLEN_METRIC_SENTENCES | CLEN_METRIC_SPECIAL)
+
+typedef struct clen_result {
+    uint64_t length;
+    uint64_t letters;
+    uint64_t upper;
+    uint64_t lower;
+    uint64_t numbers;
+    uint64_t sentences;
+    uint64_t special;
+    uint64_t words;
+    uint64_t quotes;
+} clen_result;
+
+typedef struct clen_ctx clen_ctx;
+
+/*
+ * A complete snapshot of an analyzer context: the raw counters plus the state carried across chunk
+ * boundaries. It lets callers checkpoint a stream and resume it later, or analyze independent blocks of
+ * a file and stitch them together. The counters do not yet include quote pairs that only count if the
+ * input ends while a quote is still open; clen_finish() adds those.
+ */
+typedef struct clen_state {
+    clen_result counts;
+    uint32_t inWord;
+    uint32_t quoteOpen;
+    uint32_t quoteSpecOpen;
+    uint32_t reserved;
+    uint64_t quoteSpecCount;
+} clen_state;
+
+
+
+
+
+/*
+ * Creates an analyzer context computing the metrics selected in the given CLEN_METRIC_* bitmask.
+ * Returns NULL when memory cannot be allocated. The context must be released with clen_free().
+ */
+clen_ctx *clen_new(unsigned metrics);
+
+/*
+ * Releases an analyzer context. Passing NULL is allowed.
+ */
+void clen_free(clen_ctx *ctx);
+
+/*
+ * Clears all counters and streaming state so the context can analyze a new, independent input
+ * with the same metric selection.
+ */
+void clen_reset(clen_ctx *ctx);
+
+/*
+ * Returns the metric bitmask the context was created with.
+ */
+unsigned clen_metrics(const clen_ctx *ctx);
+
+/*
+ * Streams the next len bytes of input into the analyzer. Inputs may be split at any byte boundary;
+ * the results are identical to feeding the whole input at once. NUL bytes are treated as ordinary data.
+ */
+void clen_feed(clen_ctx *ctx, const void *buf, size_t len);
+
+/*
+ * Writes the results for everything fed so far. This does not modify the context, so it can also be
+ * used to take a snapshot of a stream and keep feeding it afterwards.
+ */
+void clen_finish(const clen_ctx *ctx, clen_result *result);
+
+/*
+ * Copies the full state of a context into state, or replaces the state of a context with a snapshot
+ * taken earlier from a context with the same metric mask.
+ */
+void clen_save(const clen_ctx *ctx, clen_state *state);
+void clen_restore(clen_ctx *ctx, const clen_state *state);
+
+/*
+ * One-shot convenience wrapper that analyzes a single buffer without allocating a context.
+ */
+void clen_analyze(unsigned metrics, const void *buf, size_t len, clen_result *result);
+
+/*
+ * Adds every counter of from into into, used to build totals over many inputs.
+ */
+void clen_merge(clen_result *into, const clen_result *from);
+
+/*
+ * Computes the length and the byte-class metrics selected in metrics (see CLEN_METRIC_BYTE_CLASSES)
+ * from a histogram of how often each of the 256 byte values occurs in the input, with the same
+ * definitions as the analyzer. The other counters of result are left unchanged.
+ */
+void clen_from_histogram(unsigned metrics, const uint64_t histogram[256], clen_result *result);
+
+/*
+ * Returns the library version as a string such as "1.0.0".
+ */
+const char *clen_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "cpu.h"
+
+
+
+/*
+ * sysconf(_SC_NPROCESSORS_ONLN) counts every CPU of the host, which in a container or under taskset
+ * overstates what the process can use, and more workers than usable CPUs only adds contention. The
+ * worker count is therefore the smaller of the affinity mask (sched_getaffinity) and the cgroup CPU
+ * quota rounded up. With cgroup v2 the quota is the cpu.max of the process's cgroup and, since a
+ * parent's limit applies to all of its children, of every ancestor up to the root; the tightest one
+ * wins. On hosts that still mount the v1 cpu controller, cpu.cfs_quota_us / cpu.cfs_period_us is used.
+ */
+#define CGROUP_ROOT   "/sys/fs/cgroup"
+#define CGROUP_HYBRID "/sys/fs/cgroup/unified"
+
+
+
+
+
+/*
+ * This function reads the quota / period pair of one cgroup v2 cpu.max file, returning the quota in
+ * CPUs or 0 when the file is missing or says "max".
+ */
+static double readCpuMax(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return 0;
+    char quota[32];
+    double period = 0;
+    double cpus = 0;
+    if (fscanf(file, "%31s %lf", quota, &period) == 2 && strcmp(quota, "max") != 0 && period > 0)
+        cpus = atof(quota) / period;
+    fclose(file);
+    return cpus;
+}
+
+
+
+
+
+/*
+ * This function finds the path of the process's cgroup for the given /proc/self/cgroup controller
+ * field ("" for the cgroup v2 unified hierarchy, "cpu" for the v1 cpu controller). It returns 0 on
+ * success.
+ */
+static int findCgroup(const char *controller, char *path, size_t size) {
+    FILE *file = fopen("/proc/self/cgroup", "r");
+    if (!file)
+        return -1;
+    char line[PATH_MAX + 64];
+    int found = -1;
+    while (found != 0 && fgets(line, sizeof(line), file)) {
+        char *controllers = strchr(line, ':');
+        char *cgroup = controllers ? strchr(controllers + 1, ':') : NULL;
+        if (!cgroup)
+            continue;
+        *cgroup++ = '\0';
+        cgroup[strcspn(cgroup, "\n")] = '\0';
+        controllers++;
+
+        int match = *controller == '\0' ? *controllers == '\0' : 0;
+        for (char *name = strtok(controllers, ","); !match && name; name = strtok(NULL, ","))
+            match = strcmp(name, controller) == 0;
+        if (match && (size_t)snprintf(path, size, "%s", cgroup) < size)
+            found = 0;
+    }
+    fclose(file);
+    return found;
+}
+
+
+
+
+
+/*
+ * This function returns the tightest cgroup CPU quota that applies to the process, in CPUs, or 0 when
+ * no quota is set or none can be read.
+ */
+static double cgroupQuota(void) {
+    char cgroup[PATH_MAX], path[PATH_MAX + 64];
+    double quota = 0;
+
+    if (findCgroup("", cgroup, sizeof(cgroup)) == 0) {
+        const char *root = access(CGROUP_ROOT "/cgroup.controllers", F_OK) == 0 ? CGROUP_ROOT : CGROUP_HYBRID;
+        for (;;) {
+            snprintf(path, sizeof(path), "%s%s/cpu.max", root, strcmp(cgroup, "/") == 0 ? "" : cgroup);
+            double cpus = readCpuMax(path);
+            if (cpus > 0 && (quota == 0 || cpus < quota))
+                quota = cpus;
+            char *slash = strrchr(cgroup, '/');
+            if (!slash || slash == cgroup)
+                break;
+            *slash = '\0';
+        }
+        if (quota > 0)
+            return quota;
+    }
+
+    if (findCgroup("cpu", cgroup, sizeof(cgroup)) == 0) {
+        long long cfsQuota = 0, cfsPeriod = 0;
+        snprintf(path, sizeof(path), "%s/cpu%s/cpu.cfs_quota_us", CGROUP_ROOT, strcmp(cgroup, "/") == 0 ? "" : cgroup);
+        FILE *file = fopen(path, "r");
+        if (file) {
+            if (fscanf(file, "%lld", &cfsQuota) != 1)
+                cfsQuota = 0;
+            fclose(file);
+        }
+        snprintf(path, sizeof(path), "%s/cpu%s/cpu.cfs_period_us", CGROUP_ROOT, strcmp(cgroup, "/") == 0 ? "" : cgroup);
+        file = fopen(path, "r");
+        if (file) {
+            if (fscanf(file, "%lld", &cfsPeriod) != 1)
+                cfsPeriod = 0;
+            fclose(file);
+        }
+        if (cfsQuota > 0 && cfsPeriod > 0)
+            quota = (double)cfsQuota / (double)cfsPeriod;
+    }
+    return quota;
+}
+
+
+
+
+
+/*
+ * This function determines how many worker threads the process should run: the number of CPUs in its
+ * affinity mask, lowered to the cgroup CPU quota rounded up, and never less than one.
+ */
+void cpuGetBudget(CpuBudget *budget) {
+    cpu_set_t set;
+    budget->online = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    budget->affinity = sched_getaffinity(0, sizeof(set), &set) == 0 ? CPU_COUNT(&set) : budget->online;
+    budget->quota = cgroupQuota();
+
+    budget->threads = budget->affinity;
+    if (budget->quota > 0) {
+        int quotaThreads = (int)budget->quota;
+        if (quotaThreads < budget->quota)
+            quotaThreads++;
+        if (quotaThreads < budget->threads)
+            budget->threads = quotaThreads;
+    }
+    if (budget->threads < 1)
+        budget->threads = 1;
+}
+
+
+
+
+
+/*
+ * This function pins the calling thread to one CPU of the process's affinity mask, chosen round-robin
+ * by index, so workers spread over the allowed CPUs instead of migrating between them. It returns the
+ * CPU number, or -1 when the thread could not be pinned. Threads inherit the affinity of the thread
+ * that creates them, so a thread must only pin itself after it has started all the others.
+ */
+int cpuPinThread(int index) {
+    cpu_set_t allowed, one;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+        return -1;
+    int skip = index % CPU_COUNT(&allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed) || skip-- > 0)
+            continue;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        return pthread_setaffinity_np(pthread_self(), sizeof(one), &one) == 0 ? cpu : -1;
+    }
+    return -1;
+}
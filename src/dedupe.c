@@ -0,0 +1,198 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dedupe.h"
+
+
+
+/*
+ * The dedupe table remembers the result of every file analyzed in this run and finds it again three
+ * ways: by file identity (device, inode), which catches hardlinks and repeated arguments before a
+ * single byte is read; and by content (size plus XXH64 hash), computed in the same pass that
+ * analyzes the file.
+ *
+ * Both lookups share one open-addressing index of (kind, key1, key2) -> entry slots over a
+ * growing array of results. The index is rebuilt at twice the size when it passes 50% load.
+ */
+#define KEY_INODE   1
+#define KEY_CONTENT 2
+
+typedef struct {
+    uint32_t kind;
+    uint32_t entry;
+    uint64_t key1;
+    uint64_t key2;
+} DedupeSlot;
+
+struct DedupeTable {
+    clen_result *entries;
+    uint32_t entryCount;
+    uint32_t entryCap;
+    DedupeSlot *slots;
+    uint64_t slotCap;
+    uint64_t slotUsed;
+};
+
+
+
+
+
+/*
+ * This function hashes a lookup key into a slot position (the splitmix64 finalizer).
+ */
+static uint64_t slotHash(uint32_t kind, uint64_t key1, uint64_t key2) {
+    uint64_t h = key1 ^ (key2 * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t)kind << 60);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+
+
+
+
+/*
+ * This function returns the slot holding a key, or the empty slot where it would be inserted.
+ */
+static DedupeSlot *findSlot(const DedupeTable *table, uint32_t kind, uint64_t key1, uint64_t key2) {
+    uint64_t mask = table->slotCap - 1;
+    for (uint64_t i = slotHash(kind, key1, key2) & mask;; i = (i + 1) & mask) {
+        DedupeSlot *slot = &table->slots[i];
+        if (!slot->kind || (slot->kind == kind && slot->key1 == key1 && slot->key2 == key2))
+            return slot;
+    }
+}
+
+
+
+
+
+/*
+ * This function points a key at an entry, keeping the first entry when the key is already present.
+ * It grows the index first when needed and returns -1 if memory runs out.
+ */
+static int insertKey(DedupeTable *table, uint32_t kind, uint64_t key1, uint64_t key2, uint32_t entry) {
+    if ((table->slotUsed + 1) * 2 > table->slotCap) {
+        DedupeSlot *old = table->slots;
+        uint64_t oldCap = table->slotCap;
+        DedupeSlot *grown = calloc((size_t)oldCap * 2, sizeof(DedupeSlot));
+        if (!grown)
+            return -1;
+        table->slots = grown;
+        table->slotCap = oldCap * 2;
+        for (uint64_t i = 0; i < oldCap; i++)
+            if (old[i].kind)
+                *findSlot(table, old[i].kind, old[i].key1, old[i].key2) = old[i];
+        free(old);
+    }
+    DedupeSlot *slot = findSlot(table, kind, key1, key2);
+    if (!slot->kind) {
+        slot->kind = kind;
+        slot->key1 = key1;
+        slot->key2 = key2;
+        slot->entry = entry;
+        table->slotUsed++;
+    }
+    return 0;
+}
+
+
+
+
+
+DedupeTable *dedupeNew(void) {
+    DedupeTable *table = calloc(1, sizeof(*table));
+    if (!table)
+        return NULL;
+    table->slotCap = 1024;
+    table->slots = calloc((size_t)table->slotCap, sizeof(DedupeSlot));
+    if (!table->slots) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+
+
+
+
+void dedupeFree(DedupeTable *table) {
+    if (!table)
+        return;
+    free(table->entries);
+    free(table->slots);
+    free(table);
+}
+
+
+
+
+
+const clen_result *dedupeFindInode(const DedupeTable *table, uint64_t dev, uint64_t ino) {
+    const DedupeSlot *slot = findSlot(table, KEY_INODE, dev, ino);
+    return slot->kind ? &table->entries[slot->entry] : NULL;
+}
+
+
+
+
+
+const clen_result *dedupeFindContent(const DedupeTable *table, uint64_t size, uint64_t hash) {
+    const DedupeSlot *slot = findSlot(table, KEY_CONTENT, size, hash);
+    return slot->kind ? &table->entries[slot->entry] : NULL;
+}
+
+
+
+
+
+/*
+ * This function records the result of a file. Without a content hash (for example when the result
+ * came from the persistent cache) the file can still be found by inode, but not by content.
+ */
+void dedupeAdd(DedupeTable *table, uint64_t dev, uint64_t ino, uint64_t size, int hasHash, uint64_t hash, const clen_result *result) {
+    if (table->entryCount == table->entryCap) {
+        uint32_t cap = table->entryCap ? table->entryCap * 2 : 256;
+        clen_result *grown = realloc(table->entries, (size_t)cap * sizeof(clen_result));
+        if (!grown)
+            return;
+        table->entries = grown;
+        table->entryCap = cap;
+    }
+    uint32_t index = table->entryCount++;
+    table->entries[index] = *result;
+
+    insertKey(table, KEY_INODE, dev, ino, index);
+    if (hasHash)
+        insertKey(table, KEY_CONTENT, size, hash, index);
+}
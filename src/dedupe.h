@@ -0,0 +1,42 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef CLEN_DEDUPE_H
+#define CLEN_DEDUPE_H
+
+#include <stdint.h>
+
+#include "clen.h"
+
+typedef struct DedupeTable DedupeTable;
+
+DedupeTable *dedupeNew(void);
+void dedupeFree(DedupeTable *table);
+const clen_result *dedupeFindInode(const DedupeTable *table, uint64_t dev, uint64_t ino);
+const clen_result *dedupeFindContent(const DedupeTable *table, uint64_t size, uint64_t hash);
+void dedupeAdd(DedupeTable *table, uint64_t dev, uint64_t ino, uint64_t size, int hasHash, uint64_t hash, const clen_result *result);
+
+#endif
@@ -0,0 +1,589 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "extras.h"
+#include "tokens.h"
+#include "topwords.h"
+#include "hll.h"
+#include "histogram.h"
+
+
+
+/*
+ * The extras bundle every additional analysis of a run. Input arrives one argument at a time:
+ * extrasFeed() for each chunk, then extrasEndInput() once the argument is complete, so words cut by a
+ * chunk boundary are still seen whole but never run across two arguments. Results that describe the
+ * whole run are printed by extrasPrintRun() after the last argument.
+ *
+ * Distinct words and lines are estimated per argument with their own HyperLogLog sketches, which are
+ * merged into the run's sketches when the argument ends and then cleared for the next one.
+ *
+ * The byte histogram of an argument stays available after the argument ended, since its byte-class
+ * counters are derived from it and it is printed below them; it is cleared when the next argument
+ * starts. User-defined byte classes are counted from the same histogram.
+ *
+ * Literal patterns are counted by a scan of the compiled set, collected into the argument's counts
+ * when it ends and added to the run's counts from there. Regular expressions work the same way, with
+ * one scan (and DFA cache) per expression, and count matching lines instead of occurrences.
+ */
+#define DISTINCT_MAGIC   "CLENHLL"
+#define DISTINCT_VERSION 1
+#define DISTINCT_WORDS   1u
+#define DISTINCT_LINES   2u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t precision;
+    uint32_t sketches;
+    uint32_t reserved;
+} DistinctHeader;
+
+struct Extras {
+    ExtrasOptions options;
+    WordSplitter words;
+    LineSplitter lines;
+    TopWords *top;
+    TopWord *list;
+    Hll inputWords, runWords;
+    Hll inputLines, runLines;
+    double inputWordsEstimate;
+    double inputLinesEstimate;
+    ByteHistogram inputBytes, runBytes;
+    int inputEnded;
+    PatternScan scan;
+    uint64_t *inputMatches, *runMatches;
+    RegexpScan **regexScans;
+    uint64_t *inputRegexLines, *runRegexLines;
+    LengthSketch *inputLineLengths, *runLineLengths;
+    LengthSketch *inputWordLengths, *runWordLengths;
+};
+
+
+
+
+
+/*
+ * This function tells whether any additional analysis was asked for.
+ */
+int extrasRequested(const ExtrasOptions *options) {
+    return options->topWords > 0 || options->distinctWords || options->distinctLines ||
+           options->byteHistogram || options->entropy || options->patterns || options->classCount ||
+           options->regexCount || options->lengthStats;
+}
+
+
+
+
+
+/*
+ * This function tells whether the byte histogram has to be collected.
+ */
+static int histogramNeeded(const ExtrasOptions *options) {
+    return options->byteHistogram || options->entropy || options->classCount;
+}
+
+
+
+
+
+/*
+ * This function empties the length sketches of the current argument. Most arguments are small and
+ * leave them empty, so that case skips clearing the buckets.
+ */
+static void clearLengths(Extras *extras) {
+    if (!extras->options.lengthStats)
+        return;
+    if (extras->inputLineLengths->total)
+        lengthsClear(extras->inputLineLengths);
+    if (extras->inputWordLengths->total)
+        lengthsClear(extras->inputWordLengths);
+}
+
+
+
+
+
+/*
+ * This function is the word handler: it passes every word to the analyses that work on words.
+ */
+static void onWord(void *user, const unsigned char *word, size_t len, uint64_t length, uint64_t hash) {
+    Extras *extras = user;
+    if (extras->top)
+        topWordsAdd(extras->top, word, len, length, hash);
+    if (extras->options.distinctWords)
+        hllAdd(&extras->inputWords, hash);
+    if (extras->options.lengthStats)
+        lengthsAdd(extras->inputWordLengths, length);
+}
+
+
+
+
+
+/*
+ * This function is the line handler: it passes every line to the analyses that work on lines.
+ */
+static void onLine(void *user, uint64_t length, uint64_t hash) {
+    Extras *extras = user;
+    if (extras->options.distinctLines)
+        hllAdd(&extras->inputLines, hash);
+    if (extras->options.lengthStats)
+        lengthsAdd(extras->inputLineLengths, length);
+}
+
+
+
+
+
+/*
+ * This function creates the state for the requested analyses. Returns NULL when memory cannot be
+ * allocated.
+ */
+Extras *extrasNew(const ExtrasOptions *options) {
+    Extras *extras = calloc(1, sizeof(*extras));
+    if (!extras)
+        return NULL;
+    extras->options = *options;
+    wordsInit(&extras->words, onWord, extras);
+    linesInit(&extras->lines, onLine, extras);
+    extras->words.hashed = options->topWords > 0 || options->distinctWords;
+    extras->lines.hashed = options->distinctLines;
+    if (options->distinctWords && (hllInit(&extras->inputWords, options->distinctPrecision) != 0 ||
+                                   hllInit(&extras->runWords, options->distinctPrecision) != 0)) {
+        extrasFree(extras);
+        return NULL;
+    }
+    if (options->distinctLines && (hllInit(&extras->inputLines, options->distinctPrecision) != 0 ||
+                                   hllInit(&extras->runLines, options->distinctPrecision) != 0)) {
+        extrasFree(extras);
+        return NULL;
+    }
+    if (options->topWords) {
+        extras->top = topWordsNew(options->topWords, options->topWordsMemory);
+        extras->list = calloc(options->topWords, sizeof(TopWord));
+        if (!extras->top || !extras->list) {
+            extrasFree(extras);
+            return NULL;
+        }
+    }
+    if (options->patterns) {
+        extras->inputMatches = calloc(patternsCount(options->patterns), sizeof(uint64_t));
+        extras->runMatches = calloc(patternsCount(options->patterns), sizeof(uint64_t));
+        if (!extras->inputMatches || !extras->runMatches || patternScanInit(&extras->scan, options->patterns) != 0) {
+            extrasFree(extras);
+            return NULL;
+        }
+    }
+    if (options->lengthStats) {
+        LengthSketch *sketches = calloc(4, sizeof(LengthSketch));
+        if (!sketches) {
+            extrasFree(extras);
+            return NULL;
+        }
+        extras->inputLineLengths = &sketches[0];
+        extras->runLineLengths = &sketches[1];
+        extras->inputWordLengths = &sketches[2];
+        extras->runWordLengths = &sketches[3];
+    }
+    if (options->regexCount) {
+        extras->regexScans = calloc(options->regexCount, sizeof(RegexpScan *));
+        extras->inputRegexLines = calloc(options->regexCount, sizeof(uint64_t));
+        extras->runRegexLines = calloc(options->regexCount, sizeof(uint64_t));
+        if (!extras->regexScans || !extras->inputRegexLines || !extras->runRegexLines) {
+            extrasFree(extras);
+            return NULL;
+        }
+        for (size_t i = 0; i < options->regexCount; i++) {
+            if (!(extras->regexScans[i] = regexpScanNew(options->regexes[i], (size_t)options->regexCache))) {
+                extrasFree(extras);
+                return NULL;
+            }
+        }
+    }
+    return extras;
+}
+
+
+
+
+
+/*
+ * This function releases the extras. Passing NULL is allowed.
+ */
+void extrasFree(Extras *extras) {
+    if (!extras)
+        return;
+    topWordsFree(extras->top);
+    free(extras->list);
+    hllFree(&extras->inputWords);
+    hllFree(&extras->runWords);
+    hllFree(&extras->inputLines);
+    hllFree(&extras->runLines);
+    patternScanFree(&extras->scan);
+    free(extras->inputMatches);
+    free(extras->runMatches);
+    for (size_t i = 0; extras->regexScans && i < extras->options.regexCount; i++)
+        regexpScanFree(extras->regexScans[i]);
+    free(extras->regexScans);
+    free(extras->inputRegexLines);
+    free(extras->runRegexLines);
+    free(extras->inputLineLengths);
+    free(extras);
+}
+
+
+
+
+
+/*
+ * This function feeds the next chunk of the current argument. Its signature matches the tap of an
+ * IoSink, so file content reaches it straight from the reader.
+ */
+void extrasFeed(void *user, const void *data, size_t len) {
+    Extras *extras = user;
+    if (extras->inputEnded) {
+        memset(&extras->inputBytes, 0, sizeof(extras->inputBytes));
+        clearLengths(extras);
+        extras->inputEnded = 0;
+    }
+    if (histogramNeeded(&extras->options))
+        histogramFeed(&extras->inputBytes, data, len);
+    if (extras->options.topWords || extras->options.distinctWords || extras->options.lengthStats)
+        wordsFeed(&extras->words, data, len);
+    if (extras->options.distinctLines || extras->options.lengthStats)
+        linesFeed(&extras->lines, data, len);
+    if (extras->options.patterns)
+        patternScanFeed(&extras->scan, data, len);
+    for (size_t i = 0; i < extras->options.regexCount; i++)
+        regexpScanFeed(extras->regexScans[i], data, len);
+}
+
+
+
+
+
+/*
+ * This function returns the metrics that are derived from the byte histogram instead of being
+ * counted by the analyzer, which then only needs to run the remaining (stateful) metrics.
+ */
+unsigned extrasDerivedMetrics(const ExtrasOptions *options) {
+    return histogramNeeded(options) ? CLEN_METRIC_BYTE_CLASSES : 0;
+}
+
+
+
+
+
+/*
+ * This function fills in the derived metrics of the argument that just ended from its histogram.
+ */
+void extrasDeriveCounts(const Extras *extras, unsigned metrics, clen_result *result) {
+    if (extrasDerivedMetrics(&extras->options))
+        clen_from_histogram(metrics & CLEN_METRIC_BYTE_CLASSES, extras->inputBytes.counts, result);
+}
+
+
+
+
+
+/*
+ * This function prints the non-zero bins of a byte histogram, printable characters with their glyph.
+ */
+static void printHistogram(const ByteHistogram *histogram) {
+    for (int b = 0; b < 256; b++) {
+        if (!histogram->counts[b])
+            continue;
+        if (b > ' ' && b < 0x7f)
+            printf("    - %" PRIu64 " Bytes of 0x%02x (%c)\n", histogram->counts[b], b, b);
+        else
+            printf("    - %" PRIu64 " Bytes of 0x%02x\n", histogram->counts[b], b);
+    }
+}
+
+
+
+
+
+/*
+ * This function prints how many bytes of each user-defined class a histogram holds.
+ */
+static void printClasses(const ExtrasOptions *options, const ByteHistogram *histogram) {
+    for (size_t i = 0; i < options->classCount; i++)
+        printf("    - %" PRIu64 " %s (Class)\n", charClassCount(&options->classes[i], histogram->counts), options->classes[i].name);
+}
+
+
+
+
+
+/*
+ * This function prints how often each pattern occurred.
+ */
+static void printMatches(const Patterns *patterns, const uint64_t *counts) {
+    for (size_t i = 0; i < patternsCount(patterns); i++) {
+        size_t len;
+        const char *pattern = patternsGet(patterns, i, &len);
+        printf("    - %" PRIu64 " Matches of %.*s\n", counts[i], (int)len, pattern);
+    }
+}
+
+
+
+
+
+/*
+ * This function prints the distribution of one kind of length.
+ */
+static void printLengths(const char *kind, const LengthSketch *sketch) {
+    printf("    - %s Lengths (%" PRIu64 " %ss)\n", kind, sketch->total, kind);
+    if (!sketch->total)
+        return;
+    printf("        - %" PRIu64 " Min\n", sketch->min);
+    printf("        - %.1f Mean\n", lengthsMean(sketch));
+    printf("        - %" PRIu64 " p50\n", lengthsQuantile(sketch, 50));
+    printf("        - %" PRIu64 " p90\n", lengthsQuantile(sketch, 90));
+    printf("        - %" PRIu64 " p99\n", lengthsQuantile(sketch, 99));
+    printf("        - %" PRIu64 " Max\n", sketch->max);
+}
+
+
+
+
+
+/*
+ * This function completes the current argument: it flushes a word or line that runs up to its end and
+ * folds the argument's sketches and pattern counts into the run's.
+ */
+void extrasEndInput(Extras *extras) {
+    if (extras->inputEnded) {
+        memset(&extras->inputBytes, 0, sizeof(extras->inputBytes));
+        clearLengths(extras);
+    }
+    extras->inputEnded = 1;
+    histogramMerge(&extras->runBytes, &extras->inputBytes);
+    wordsFinish(&extras->words);
+    linesFinish(&extras->lines);
+    if (extras->options.distinctWords) {
+        extras->inputWordsEstimate = hllEstimate(&extras->inputWords);
+        hllMerge(&extras->runWords, &extras->inputWords);
+        hllClear(&extras->inputWords);
+    }
+    if (extras->options.distinctLines) {
+        extras->inputLinesEstimate = hllEstimate(&extras->inputLines);
+        hllMerge(&extras->runLines, &extras->inputLines);
+        hllClear(&extras->inputLines);
+    }
+    if (extras->options.patterns) {
+        size_t count = patternsCount(extras->options.patterns);
+        memset(extras->inputMatches, 0, count * sizeof(uint64_t));
+        patternScanCollect(&extras->scan, extras->inputMatches);
+        for (size_t i = 0; i < count; i++)
+            extras->runMatches[i] += extras->inputMatches[i];
+    }
+    if (extras->options.lengthStats) {
+        lengthsMerge(extras->runLineLengths, extras->inputLineLengths);
+        lengthsMerge(extras->runWordLengths, extras->inputWordLengths);
+    }
+    for (size_t i = 0; i < extras->options.regexCount; i++) {
+        extras->inputRegexLines[i] = regexpScanFinish(extras->regexScans[i]);
+        extras->runRegexLines[i] += extras->inputRegexLines[i];
+    }
+}
+
+
+
+
+
+/*
+ * This function prints the results of the argument that just ended, below its other metrics.
+ */
+void extrasPrintInput(const Extras *extras) {
+    if (extras->options.distinctWords)
+        printf("    - ~%.0f Distinct Words\n", extras->inputWordsEstimate);
+    if (extras->options.distinctLines)
+        printf("    - ~%.0f Distinct Lines\n", extras->inputLinesEstimate);
+    if (extras->options.entropy)
+        printf("    - %.4f Bits per byte (Entropy)\n", histogramEntropy(&extras->inputBytes));
+    if (extras->options.byteHistogram)
+        printHistogram(&extras->inputBytes);
+    printClasses(&extras->options, &extras->inputBytes);
+    if (extras->options.patterns)
+        printMatches(extras->options.patterns, extras->inputMatches);
+    for (size_t i = 0; i < extras->options.regexCount; i++)
+        printf("    - %" PRIu64 " Lines matching %s\n", extras->inputRegexLines[i], regexpSource(extras->options.regexes[i]));
+    if (extras->options.lengthStats) {
+        printLengths("Line", extras->inputLineLengths);
+        printLengths("Word", extras->inputWordLengths);
+    }
+}
+
+
+
+
+
+/*
+ * This function prints the results that cover the whole run, in the same layout as the totals.
+ */
+void extrasPrintRun(const Extras *extras) {
+    if (extras->top) {
+        size_t n = topWordsList(extras->top, extras->list);
+        if (topWordsApproximate(extras->top))
+            printf("Top Words (approximate, counts overstate by at most %" PRIu64 ")\n", topWordsErrorBound(extras->top));
+        else
+            printf("Top Words\n");
+        for (size_t i = 0; i < n; i++) {
+            const TopWord *w = &extras->list[i];
+            printf("    - %" PRIu64 " %.*s%s", w->count, (int)w->len, (const char *)w->word, w->truncated ? "..." : "");
+            if (w->error)
+                printf(" (at most %" PRIu64 " over)", w->error);
+            printf("\n");
+        }
+        printf("\n");
+    }
+
+    if (extras->options.distinctWords || extras->options.distinctLines) {
+        printf("Distinct (All Arguments)\n");
+        if (extras->options.distinctWords)
+            printf("    - ~%.0f Words\n", hllEstimate(&extras->runWords));
+        if (extras->options.distinctLines)
+            printf("    - ~%.0f Lines\n", hllEstimate(&extras->runLines));
+        printf("\n");
+    }
+
+    if (extras->options.byteHistogram || extras->options.entropy) {
+        printf("Bytes (All Arguments)\n");
+        if (extras->options.entropy)
+            printf("    - %.4f Bits per byte (Entropy)\n", histogramEntropy(&extras->runBytes));
+        if (extras->options.byteHistogram)
+            printHistogram(&extras->runBytes);
+        printf("\n");
+    }
+
+    if (extras->options.classCount) {
+        printf("Classes (All Arguments)\n");
+        printClasses(&extras->options, &extras->runBytes);
+        printf("\n");
+    }
+
+    if (extras->options.patterns) {
+        printf("Patterns (All Arguments)\n");
+        printMatches(extras->options.patterns, extras->runMatches);
+        printf("\n");
+    }
+
+    if (extras->options.regexCount) {
+        printf("Regular Expressions (All Arguments)\n");
+        for (size_t i = 0; i < extras->options.regexCount; i++) {
+            printf("    - %" PRIu64 " Lines matching %s", extras->runRegexLines[i], regexpSource(extras->options.regexes[i]));
+            if (regexpScanFellBack(extras->regexScans[i]))
+                printf(" (DFA cache thrashed, finished without it)");
+            printf("\n");
+        }
+        printf("\n");
+    }
+
+    if (extras->options.lengthStats) {
+        printf("Lengths (All Arguments)\n");
+        printLengths("Line", extras->runLineLengths);
+        printLengths("Word", extras->runWordLengths);
+        printf("\n");
+    }
+}
+
+
+
+
+
+/*
+ * This function merges the distinct sketches saved by an earlier run (or another shard) into this
+ * run's sketches. Sketches the file has but this run does not count are ignored. It returns 0 on
+ * success and -1 when the file cannot be read or was written with a different precision.
+ */
+int extrasMergeDistinct(Extras *extras, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return -1;
+    DistinctHeader header;
+    int status = -1;
+    if (fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, DISTINCT_MAGIC, sizeof(DISTINCT_MAGIC)) == 0 &&
+        header.version == DISTINCT_VERSION && header.precision == extras->options.distinctPrecision) {
+        Hll loaded;
+        if (hllInit(&loaded, header.precision) == 0) {
+            size_t size = (size_t)1 << header.precision;
+            status = 0;
+            for (unsigned kind = DISTINCT_WORDS; kind <= DISTINCT_LINES && status == 0; kind <<= 1) {
+                if (!(header.sketches & kind))
+                    continue;
+                if (fread(loaded.registers, 1, size, file) != size) {
+                    status = -1;
+                    break;
+                }
+                if (kind == DISTINCT_WORDS && extras->options.distinctWords)
+                    hllMerge(&extras->runWords, &loaded);
+                if (kind == DISTINCT_LINES && extras->options.distinctLines)
+                    hllMerge(&extras->runLines, &loaded);
+            }
+            hllFree(&loaded);
+        }
+    }
+    fclose(file);
+    return status;
+}
+
+
+
+
+
+/*
+ * This function writes this run's distinct sketches to a file that later runs can merge with
+ * --distinct-merge. It returns 0 on success and -1 on a write error.
+ */
+int extrasSaveDistinct(const Extras *extras, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return -1;
+    DistinctHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DISTINCT_MAGIC, sizeof(DISTINCT_MAGIC));
+    header.version = DISTINCT_VERSION;
+    header.precision = extras->options.distinctPrecision;
+    header.sketches = (extras->options.distinctWords ? DISTINCT_WORDS : 0) | (extras->options.distinctLines ? DISTINCT_LINES : 0);
+
+    size_t size = (size_t)1 << header.precision;
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && extras->options.distinctWords)
+        ok = fwrite(extras->runWords.registers, 1, size, file) == size;
+    if (ok && extras->options.distinctLines)
+        ok = fwrite(extras->runLines.registers, 1, size, file) == size;
+    return fclose(file) == 0 && ok ? 0 : -1;
+}
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_EXTRAS_H
+#define CLEN_EXTRAS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "clen.h"
+#include "patterns.h"
+#include "charclass.h"
+#include "regexp.h"
+#include "lengths.h"
+
+/*
+ * The analyses that go beyond the counters of libclen. They see the same chunks as the analyzer, in
+ * the same pass, through the tap of an IoSink (or directly for text arguments).
+ */
+typedef struct {
+    size_t topWords;
+    uint64_t topWordsMemory;
+    int distinctWords;
+    int distinctLines;
+    unsigned distinctPrecision;
+    int byteHistogram;
+    int entropy;
+    const Patterns *patterns;
+    const CharClass *classes;
+    size_t classCount;
+    Regexp *const *regexes;
+    size_t regexCount;
+    uint64_t regexCache;
+    int lengthStats;
+} ExtrasOptions;
+
+typedef struct Extras Extras;
+
+int extrasRequested(const ExtrasOptions *options);
+Extras *extrasNew(const ExtrasOptions *options);
+void extrasFree(Extras *extras);
+void extrasFeed(void *extras, const void *data, size_t len);
+unsigned extrasDerivedMetrics(const ExtrasOptions *options);
+void extrasDeriveCounts(const Extras *extras, unsigned metrics, clen_result *result);
+void extrasEndInput(Extras *extras);
+void extrasPrintInput(const Extras *extras);
+void extrasPrintRun(const Extras *extras);
+int extrasMergeDistinct(Extras *extras, const char *path);
+int extrasSaveDistinct(const Extras *extras, const char *path);
+
+#endif
@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+#include "follow.h"
+#include "io.h"
+
+
+
+/*
+ * Follow mode keeps one analyzer context per followed stream and only ever feeds it the bytes that
+ * were appended since the last look, so word, sentence and quote state carries over between appends
+ * exactly as if the whole file had been read at once.
+ *
+ * The file is watched with inotify when available; the poll interval is also a timeout so changes are
+ * picked up even without inotify (for example on network filesystems). On every wake-up the path is
+ * checked for rotation (it now names a different inode) and the open file for truncation (it is
+ * shorter than what was already read). Either one ends the current stream: its results are kept in
+ * the running totals and analysis restarts from the beginning of the new content.
+ */
+typedef struct {
+    int fd;
+    dev_t dev;
+    ino_t ino;
+    off_t offset;
+} FollowStream;
+
+
+
+
+
+/*
+ * This function opens the followed path as a new stream starting at offset zero.
+ */
+static int followOpen(const char *path, FollowStream *stream) {
+    struct stat st;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    stream->fd = fd;
+    stream->dev = st.st_dev;
+    stream->ino = st.st_ino;
+    stream->offset = 0;
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function feeds everything between the stream offset and the current end of the file into the
+ * analyzer and returns the number of bytes read.
+ */
+static uint64_t followDrain(FollowStream *stream, clen_ctx *ctx) {
+    unsigned char buffer[64 * 1024];
+    uint64_t total = 0;
+    ssize_t got;
+    while ((got = pread(stream->fd, buffer, sizeof(buffer), stream->offset)) > 0) {
+        clen_feed(ctx, buffer, (size_t)got);
+        stream->offset += got;
+        total += (uint64_t)got;
+        ioThrottle((uint64_t)got);
+    }
+    return total;
+}
+
+
+
+
+
+/*
+ * This function reports the running totals: the finished earlier streams plus a snapshot of the
+ * current one.
+ */
+static void followReport(const clen_result *previous, const clen_ctx *ctx, uint64_t newBytes,
+                         const char *event, FollowReport report, void *user) {
+    clen_result totals = *previous;
+    clen_result current;
+    clen_finish(ctx, &current);
+    clen_merge(&totals, &current);
+    report(&totals, newBytes, event, user);
+}
+
+
+
+
+
+/*
+ * This function follows a growing file like tail -F, reporting updated running totals after every
+ * change. It only returns on an error that makes following impossible.
+ */
+int followFile(const char *path, unsigned metrics, long intervalMs, FollowReport report, void *user) {
+    FollowStream stream;
+    if (followOpen(path, &stream) != 0) {
+        fprintf(stderr, "Could not open file: %s\n", path);
+        return 1;
+    }
+    clen_ctx *ctx = clen_new(metrics);
+    if (!ctx) {
+        close(stream.fd);
+        return 1;
+    }
+    clen_result previous;
+    memset(&previous, 0, sizeof(previous));
+
+    int notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    uint32_t watchMask = IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF | IN_CLOSE_WRITE;
+    int watch = notify >= 0 ? inotify_add_watch(notify, path, watchMask) : -1;
+
+    followReport(&previous, ctx, followDrain(&stream, ctx), "appended", report, user);
+
+    for (;;) {
+        struct pollfd pfd = { notify, POLLIN, 0 };
+        if (notify >= 0 && poll(&pfd, 1, (int)intervalMs) > 0) {
+            char events[4096];
+            while (read(notify, events, sizeof(events)) > 0)
+                ;
+        } else if (notify < 0) {
+            usleep((useconds_t)intervalMs * 1000);
+        }
+
+        const char *event = NULL;
+        struct stat st;
+        if (fstat(stream.fd, &st) == 0 && st.st_size < stream.offset) {
+            clen_result finished;
+            clen_finish(ctx, &finished);
+            clen_merge(&previous, &finished);
+            clen_reset(ctx);
+            stream.offset = 0;
+            event = "truncated";
+        }
+
+        uint64_t newBytes = followDrain(&stream, ctx);
+
+        if (stat(path, &st) == 0 && (st.st_dev != stream.dev || st.st_ino != stream.ino)) {
+            FollowStream next;
+            if (followOpen(path, &next) == 0) {
+                clen_result finished;
+                clen_finish(ctx, &finished);
+                clen_merge(&previous, &finished);
+                clen_reset(ctx);
+                close(stream.fd);
+                stream = next;
+                if (watch >= 0)
+                    inotify_rm_watch(notify, watch);
+                watch = notify >= 0 ? inotify_add_watch(notify, path, watchMask) : -1;
+                newBytes += followDrain(&stream, ctx);
+                event = "rotated";
+            }
+        }
+
+        if (newBytes || event)
+            followReport(&previous, ctx, newBytes, event ? event : "appended", report, user);
+    }
+}
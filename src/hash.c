@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <string.h>
+
+#include "hash.h"
+
+
+
+/*
+ * This is XXH64: four independent 64-bit lanes each consume 8 bytes of a 32-byte stripe per round,
+ * which keeps several multiplications in flight and hashes at memory speed. The short tail is mixed
+ * in at the end. It is not cryptographic; it only has to tell changed blocks and distinct files apart.
+ */
+#define PRIME1 0x9E3779B185EBCA87ULL
+#define PRIME2 0xC2B2AE3D27D4EB4FULL
+#define PRIME3 0x165667B19E3779F9ULL
+#define PRIME4 0x85EBCA77C2B2AE63ULL
+#define PRIME5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input) {
+    acc += input * PRIME2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME1;
+}
+
+static inline uint64_t mergeRound(uint64_t h, uint64_t acc) {
+    h ^= round64(0, acc);
+    return h * PRIME1 + PRIME4;
+}
+
+
+
+
+
+void hashInit(HashState *state, uint64_t seed) {
+    state->acc[0] = seed + PRIME1 + PRIME2;
+    state->acc[1] = seed + PRIME2;
+    state->acc[2] = seed;
+    state->acc[3] = seed - PRIME1;
+    state->total = 0;
+    state->stripeLen = 0;
+    state->seed = seed;
+}
+
+
+
+
+
+void hashUpdate(HashState *state, const void *data, size_t len) {
+    const unsigned char *p = data;
+    state->total += len;
+
+    if (state->stripeLen) {
+        size_t take = 32 - state->stripeLen < len ? 32 - state->stripeLen : len;
+        memcpy(state->stripe + state->stripeLen, p, take);
+        state->stripeLen += take;
+        p += take;
+        len -= take;
+        if (state->stripeLen < 32)
+            return;
+        for (int i = 0; i < 4; i++)
+            state->acc[i] = round64(state->acc[i], read64(state->stripe + 8 * i));
+        state->stripeLen = 0;
+    }
+
+    uint64_t a0 = state->acc[0], a1 = state->acc[1], a2 = state->acc[2], a3 = state->acc[3];
+    for (; len >= 32; p += 32, len -= 32) {
+        a0 = round64(a0, read64(p));
+        a1 = round64(a1, read64(p + 8));
+        a2 = round64(a2, read64(p + 16));
+        a3 = round64(a3, read64(p + 24));
+    }
+    state->acc[0] = a0, state->acc[1] = a1, state->acc[2] = a2, state->acc[3] = a3;
+
+    memcpy(state->stripe, p, len);
+    state->stripeLen = len;
+}
+
+
+
+
+
+uint64_t hashFinal(const HashState *state) {
+    uint64_t h;
+    if (state->total >= 32) {
+        h = rotl64(state->acc[0], 1) + rotl64(state->acc[1], 7) + rotl64(state->acc[2], 12) + rotl64(state->acc[3], 18);
+        for (int i = 0; i < 4; i++)
+            h = mergeRound(h, state->acc[i]);
+    } else {
+        h = state->seed + PRIME5;
+    }
+    h += state->total;
+
+    const unsigned char *p = state->stripe;
+    size_t len = state->stripeLen;
+    for (; len >= 8; p += 8, len -= 8) {
+        h ^= round64(0, read64(p));
+        h = rotl64(h, 27) * PRIME1 + PRIME4;
+    }
+    if (len >= 4) {
+        h ^= (uint64_t)read32(p) * PRIME1;
+        h = rotl64(h, 23) * PRIME2 + PRIME3;
+        p += 4;
+        len -= 4;
+    }
+    for (; len; p++, len--) {
+        h ^= (*p) * PRIME5;
+        h = rotl64(h, 11) * PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+
+
+
+
+uint64_t hash64(const void *data, size_t len, uint64_t seed) {
+    HashState state;
+    hashInit(&state, seed);
+    hashUpdate(&state, data, len);
+    return hashFinal(&state);
+}
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef CLEN_HASH_H
+#define CLEN_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Streaming state of the 64-bit content hash (the XXH64 algorithm). Data can be added in pieces of
+ * any size; the digest only depends on the concatenated bytes.
+ */
+typedef struct {
+    uint64_t acc[4];
+    uint64_t total;
+    unsigned char stripe[32];
+    size_t stripeLen;
+    uint64_t seed;
+} HashState;
+
+void hashInit(HashState *state, uint64_t seed);
+void hashUpdate(HashState *state, const void *data, size_t len);
+uint64_t hashFinal(const HashState *state);
+uint64_t hash64(const void *data, size_t len, uint64_t seed);
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <string.h>
+#include <math.h>
+
+#include "histogram.h"
+
+
+
+/*
+ * Counting bytes into a single table stalls on runs of the same byte: every increment has to wait
+ * for the store of the previous one to the same counter. The histogram therefore counts into four
+ * sub-tables in rotation, so consecutive bytes always hit different counters, and adds them up at
+ * the end of the chunk. The sub-tables use 32-bit counters and chunks are capped so they cannot
+ * overflow; short inputs skip the sub-tables altogether.
+ */
+#define HISTOGRAM_SHORT 256
+#define HISTOGRAM_SPAN  ((size_t)1 << 30)
+
+
+
+
+
+/*
+ * This function counts every byte of a chunk.
+ */
+void histogramFeed(ByteHistogram *histogram, const void *data, size_t len) {
+    const unsigned char *p = data;
+    if (len < HISTOGRAM_SHORT) {
+        for (size_t i = 0; i < len; i++)
+            histogram->counts[p[i]]++;
+        return;
+    }
+
+    uint32_t sub[4][256];
+    while (len) {
+        size_t n = len < HISTOGRAM_SPAN ? len : HISTOGRAM_SPAN;
+        memset(sub, 0, sizeof(sub));
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            sub[0][p[i]]++;
+            sub[1][p[i + 1]]++;
+            sub[2][p[i + 2]]++;
+            sub[3][p[i + 3]]++;
+        }
+        for (; i < n; i++)
+            sub[0][p[i]]++;
+        for (int b = 0; b < 256; b++)
+            histogram->counts[b] += (uint64_t)sub[0][b] + sub[1][b] + sub[2][b] + sub[3][b];
+        p += n;
+        len -= n;
+    }
+}
+
+
+
+
+
+/*
+ * This function adds the counts of one histogram to another.
+ */
+void histogramMerge(ByteHistogram *into, const ByteHistogram *from) {
+    for (int b = 0; b < 256; b++)
+        into->counts[b] += from->counts[b];
+}
+
+
+
+
+
+/*
+ * This function returns the number of bytes counted.
+ */
+uint64_t histogramTotal(const ByteHistogram *histogram) {
+    uint64_t total = 0;
+    for (int b = 0; b < 256; b++)
+        total += histogram->counts[b];
+    return total;
+}
+
+
+
+
+
+/*
+ * This function returns the Shannon entropy of the byte distribution in bits per byte: 0 for input
+ * made of a single byte value, close to 8 for compressed or encrypted data, and typically 4 to 5 for
+ * English text.
+ */
+double histogramEntropy(const ByteHistogram *histogram) {
+    uint64_t total = histogramTotal(histogram);
+    double entropy = 0;
+    for (int b = 0; b < 256 && total; b++) {
+        if (!histogram->counts[b])
+            continue;
+        double p = (double)histogram->counts[b] / (double)total;
+        entropy -= p * log2(p);
+    }
+    return entropy;
+}
@@ -0,0 +1,49 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_HLL_H
+#define CLEN_HLL_H
+
+#include <stdint.h>
+
+#define HLL_MIN_PRECISION     4
+#define HLL_MAX_PRECISION     18
+#define HLL_DEFAULT_PRECISION 14
+
+typedef struct {
+    unsigned precision;
+    uint8_t *registers;
+} Hll;
+
+int hllInit(Hll *hll, unsigned precision);
+void hllFree(Hll *hll);
+void hllClear(Hll *hll);
+void hllAdd(Hll *hll, uint64_t hash);
+int hllMerge(Hll *into, const Hll *from);
+double hllEstimate(const Hll *hll);
+
+#endif
@@ -0,0 +1,676 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <sched.h>
+#include <time.h>
+
+#include "io.h"
+#include "pool.h"
+
+
+
+
+
+/*
+ * This function checks if the given string represents a valid file path on the system.
+ * It uses the POSIX access() function with the F_OK flag to determine if the file or directory exists.
+ * This check allows the program to decide whether to process the text itself or, when applicable,
+ * to inspect the actual file content.
+ */
+int isFilePath(const char *path) {
+    return access(path, F_OK) == 0;
+}
+
+
+
+
+
+/*
+ * This function calculates the total size in bytes of the contents of a file.
+ * It opens the file in binary mode, moves the file pointer to the end with fseek(),
+ * and retrieves the position using ftell(), which gives the file size. The file is then closed.
+ * This offers an efficient method for determining file content size when the argument is a valid file path.
+ */
+size_t getFileContentLength(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return 0;
+    fseek(file, 0, SEEK_END);
+    size_t size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+
+
+
+
+/*
+ * File content can be read in different ways, and which one is fastest depends on the file. Small
+ * files are cheapest with a single read() into a stack buffer. Large files already in the page cache
+ * are fastest through mmap(), which analyzes the cached pages in place without copying them. Large
+ * cold files come from disk either way; read() with a big buffer and sequential read-ahead keeps the
+ * device busy without the page-fault overhead of mmap.
+ *
+ * In auto mode the choice is made per file from its size and a sample of its page-cache residency:
+ * the file is mapped (which costs no I/O), and mincore() is asked about IO_SAMPLE_WINDOWS evenly spread
+ * windows of IO_SAMPLE_PAGES pages. If the file cannot be mapped, a non-blocking preadv2(RWF_NOWAIT)
+ * of its first block tells whether that block is cached. The mapping made for sampling is reused when
+ * mmap wins.
+ */
+#define IO_SMALL_FILE     (64 * 1024)
+#define IO_LARGE_BUFFER   POOL_BUFFER_SIZE
+#define IO_HOT_PERCENT    50
+#define IO_SAMPLE_WINDOWS 32
+#define IO_SAMPLE_PAGES   16
+
+static IoOptions ioOptions = { IO_AUTO, 0, 0, 0 };
+
+const char *ioStrategyNames[] = { "auto", "read", "mmap", "direct" };
+
+
+
+
+
+/*
+ * This function sets the process-wide I/O options used for every file read afterwards.
+ */
+void ioSetOptions(const IoOptions *options) {
+    ioOptions = *options;
+}
+
+
+
+
+
+/*
+ * --max-read-rate and --max-iops are token buckets shared by every reader of the process, including
+ * concurrent daemon workers. Each read is charged after it completed with its size in bytes and one
+ * operation; a bucket may go into debt, and the reader then sleeps until the debt is paid back at the
+ * configured rate, so the long-run rate holds exactly while a single read may still be larger than
+ * the bucket. Buckets hold at most IO_BURST_SECONDS worth of tokens, which bounds the burst after an
+ * idle period. The bucket is updated under a mutex; the sleep happens outside of it.
+ */
+#define IO_BURST_SECONDS 0.1
+
+typedef struct {
+    double tokens;
+    struct timespec last;
+} TokenBucket;
+
+static pthread_mutex_t throttleLock = PTHREAD_MUTEX_INITIALIZER;
+static TokenBucket byteBucket, opBucket;
+
+
+
+
+
+/*
+ * This function refills a bucket for the time passed since its last use, takes cost tokens from it
+ * and returns how many seconds the caller has to wait to pay back any debt.
+ */
+static double takeTokens(TokenBucket *bucket, double rate, double cost, const struct timespec *now) {
+    if (bucket->last.tv_sec == 0 && bucket->last.tv_nsec == 0)
+        bucket->tokens = rate * IO_BURST_SECONDS;
+    else
+        bucket->tokens += rate * ((double)(now->tv_sec - bucket->last.tv_sec) + (double)(now->tv_nsec - bucket->last.tv_nsec) / 1e9);
+    if (bucket->tokens > rate * IO_BURST_SECONDS)
+        bucket->tokens = rate * IO_BURST_SECONDS;
+    bucket->last = *now;
+    bucket->tokens -= cost;
+    return bucket->tokens < 0 ? -bucket->tokens / rate : 0;
+}
+
+
+
+
+
+/*
+ * This function charges one completed read of the given size against the rate limits and sleeps as
+ * long as needed to stay within them. Without limits it returns immediately.
+ */
+void ioThrottle(uint64_t bytes) {
+    if (!ioOptions.maxReadRate && !ioOptions.maxIops)
+        return;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double wait = 0;
+    pthread_mutex_lock(&throttleLock);
+    if (ioOptions.maxReadRate)
+        wait = takeTokens(&byteBucket, (double)ioOptions.maxReadRate, (double)bytes, &now);
+    if (ioOptions.maxIops) {
+        double opWait = takeTokens(&opBucket, (double)ioOptions.maxIops, 1, &now);
+        if (opWait > wait)
+            wait = opWait;
+    }
+    pthread_mutex_unlock(&throttleLock);
+
+    if (wait > 0) {
+        struct timespec pause = { (time_t)wait, (long)((wait - (double)(time_t)wait) * 1e9) };
+        while (nanosleep(&pause, &pause) != 0 && errno == EINTR)
+            ;
+    }
+}
+
+
+
+
+
+/*
+ * This function makes the whole process yield to everything else on the host: its disk I/O moves to
+ * the idle I/O priority class, served only when no other process needs the disk, and its threads to
+ * SCHED_IDLE, which only runs when a CPU would otherwise be idle. Threads started later inherit both.
+ * It returns 0 when both took effect and -1 otherwise.
+ */
+int ioSetIdlePriority(void) {
+    const int ioprioClassIdle = 3, ioprioClassShift = 13, ioprioWhoProcess = 1;
+    int status = 0;
+    if (syscall(SYS_ioprio_set, ioprioWhoProcess, 0, ioprioClassIdle << ioprioClassShift) != 0)
+        status = -1;
+    struct sched_param param = { 0 };
+    if (sched_setscheduler(0, SCHED_IDLE, &param) != 0)
+        status = -1;
+    return status;
+}
+
+
+
+
+
+/*
+ * This function parses an I/O strategy name as given to --io. It returns 0 on success and -1 for an
+ * unknown name.
+ */
+int ioParseStrategy(const char *name, IoStrategy *strategy) {
+    for (int i = 0; i <= IO_DIRECT; i++) {
+        if (strcmp(name, ioStrategyNames[i]) == 0) {
+            *strategy = (IoStrategy)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+
+
+
+
+/*
+ * This function estimates which share (0-100) of a mapped file is resident in the page cache by asking
+ * mincore() about evenly spread sample windows. It returns -1 when mincore() is not usable.
+ */
+static int sampleResidency(void *map, size_t size) {
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    size_t pages = (size - 1) / pageSize + 1;
+    size_t window = pages < IO_SAMPLE_PAGES ? pages : IO_SAMPLE_PAGES;
+    size_t windows = pages / window < IO_SAMPLE_WINDOWS ? pages / window : IO_SAMPLE_WINDOWS;
+    unsigned char vec[IO_SAMPLE_PAGES];
+    size_t resident = 0, sampled = 0;
+
+    for (size_t w = 0; w < windows; w++) {
+        size_t first = windows > 1 ? w * (pages - window) / (windows - 1) : 0;
+        size_t bytes = window * pageSize;
+        if ((first + window) * pageSize > size)
+            bytes = size - first * pageSize;
+        if (mincore((char *)map + first * pageSize, bytes, vec) != 0)
+            return -1;
+        size_t n = (bytes - 1) / pageSize + 1;
+        for (size_t i = 0; i < n; i++)
+            resident += vec[i] & 1;
+        sampled += n;
+    }
+    return sampled ? (int)(resident * 100 / sampled) : -1;
+}
+
+
+
+
+
+/*
+ * This function probes whether the first block of a file is in the page cache without waiting for
+ * the disk: preadv2() with RWF_NOWAIT fails with EAGAIN instead of blocking on uncached data.
+ * It returns 100 for a cached block, 0 for an uncached one and -1 when the probe is not supported.
+ */
+static int probeResidency(int fd) {
+    unsigned char probe[4096];
+    struct iovec iov = { probe, sizeof(probe) };
+    ssize_t got = preadv2(fd, &iov, 1, 0, RWF_NOWAIT);
+    if (got >= 0)
+        return 100;
+    return errno == EAGAIN ? 0 : -1;
+}
+
+
+
+
+
+/*
+ * This function hands one chunk of content to the analyzer, the content hash and the tap of a sink,
+ * whichever are used.
+ */
+static inline void consume(const IoSink *sink, const void *data, size_t len) {
+    if (sink->ctx)
+        clen_feed(sink->ctx, data, len);
+    if (sink->hash)
+        hashUpdate(sink->hash, data, len);
+    if (sink->tap)
+        sink->tap(sink->user, data, len);
+}
+
+
+
+
+
+/*
+ * A mapped file that shrinks while it is scanned (log rotation with copytruncate, a writer opening it
+ * with O_TRUNC) raises SIGBUS on the first page past the new end. While a thread scans a mapping, it
+ * points mappedJump at a jump buffer and the handler returns there, so the read fails like any other
+ * read error instead of killing the process. The chunks seen so far have already reached the analyzer
+ * and the taps, so the file cannot be re-read transparently. SIGBUS outside a mapped scan keeps its
+ * default action.
+ */
+static __thread sigjmp_buf *mappedJump;
+static pthread_once_t sigbusOnce = PTHREAD_ONCE_INIT;
+
+static void onSigbus(int sig) {
+    if (mappedJump)
+        siglongjmp(*mappedJump, 1);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void installSigbusHandler(void) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSigbus;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGBUS, &action, NULL);
+}
+
+
+
+
+
+/*
+ * This function hands a mapped file to the sink, in throttled pieces when a rate or IOPS limit is set.
+ * It returns 0 on success and -1, with errno set to EIO, when the file was truncated under the scan.
+ */
+static int consumeMapped(const unsigned char *map, size_t size, const IoSink *sink) {
+    sigjmp_buf jump;
+    pthread_once(&sigbusOnce, installSigbusHandler);
+    if (sigsetjmp(jump, 1)) {
+        mappedJump = NULL;
+        errno = EIO;
+        return -1;
+    }
+    mappedJump = &jump;
+    if (ioOptions.maxReadRate || ioOptions.maxIops) {
+        for (size_t offset = 0; offset < size; offset += IO_LARGE_BUFFER) {
+            size_t piece = size - offset < IO_LARGE_BUFFER ? size - offset : IO_LARGE_BUFFER;
+            consume(sink, map + offset, piece);
+            ioThrottle(piece);
+        }
+    } else {
+        consume(sink, map, size);
+    }
+    mappedJump = NULL;
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function reads a file sequentially with read(). Small files use a 64 KiB buffer on the stack,
+ * which also keeps concurrent daemon workers independent; large files use a 1 MiB buffer from the
+ * buffer pool and announce sequential access so the kernel reads ahead aggressively.
+ */
+static int readSequential(int fd, size_t size, const IoSink *sink, uint64_t *bytesRead) {
+    unsigned char small[IO_SMALL_FILE];
+    void *pooled = NULL;
+    unsigned char *buffer = small;
+    size_t capacity = sizeof(small);
+    if (size > IO_LARGE_BUFFER && poolAcquire(&pooled, 1) == 0) {
+        buffer = pooled;
+        capacity = IO_LARGE_BUFFER;
+    }
+    if (size > IO_SMALL_FILE)
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    ssize_t got;
+    while ((got = read(fd, buffer, capacity)) > 0) {
+        consume(sink, buffer, (size_t)got);
+        *bytesRead += (uint64_t)got;
+        ioThrottle((uint64_t)got);
+    }
+    if (pooled)
+        poolRelease(&pooled, 1);
+    return got < 0 ? -1 : 0;
+}
+
+
+
+
+
+/*
+ * The --direct-io reader keeps the analyzer and the disk busy at the same time: a reader thread fills
+ * one of two aligned pool buffers with O_DIRECT reads while the calling thread analyzes the other. Every
+ * slot is handed over under the mutex; a slot is full from the reader's read() until the analyzer has
+ * consumed it. When O_DIRECT is rejected (on open or on the first read), the reader continues with
+ * ordinary reads and drops each chunk from the page cache with POSIX_FADV_DONTNEED once it was read,
+ * so a cold scan still leaves the cache of other processes alone.
+ */
+typedef struct {
+    int fd;
+    int direct;
+    unsigned char *buffer[2];
+    ssize_t length[2];
+    int full[2];
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} DirectReader;
+
+
+
+
+
+/*
+ * This function reads one chunk into a buffer. A read rejected with EINVAL while O_DIRECT is active
+ * switches the descriptor to buffered reads and retries; buffered chunks are dropped from the page
+ * cache right after reading.
+ */
+static ssize_t directRead(DirectReader *reader, unsigned char *buffer, off_t offset) {
+    ssize_t got = pread(reader->fd, buffer, IO_LARGE_BUFFER, offset);
+    if (got < 0 && errno == EINVAL && reader->direct) {
+        int flags = fcntl(reader->fd, F_GETFL);
+        if (flags == -1 || fcntl(reader->fd, F_SETFL, flags & ~O_DIRECT) == -1)
+            return -1;
+        reader->direct = 0;
+        got = pread(reader->fd, buffer, IO_LARGE_BUFFER, offset);
+    }
+    if (got > 0 && !reader->direct)
+        posix_fadvise(reader->fd, offset, got, POSIX_FADV_DONTNEED);
+    if (got > 0)
+        ioThrottle((uint64_t)got);
+    return got;
+}
+
+
+
+
+
+/*
+ * This function is the reader thread: it fills the two buffers in turn until the end of the file or
+ * an error, which it hands over as a length of 0 or -1.
+ */
+static void *directReaderThread(void *arg) {
+    DirectReader *reader = arg;
+    off_t offset = 0;
+    for (int slot = 0;; slot ^= 1) {
+        pthread_mutex_lock(&reader->lock);
+        while (reader->full[slot])
+            pthread_cond_wait(&reader->changed, &reader->lock);
+        pthread_mutex_unlock(&reader->lock);
+
+        ssize_t got = directRead(reader, reader->buffer[slot], offset);
+
+        pthread_mutex_lock(&reader->lock);
+        reader->length[slot] = got;
+        reader->full[slot] = 1;
+        pthread_cond_broadcast(&reader->changed);
+        pthread_mutex_unlock(&reader->lock);
+        if (got <= 0)
+            return NULL;
+        offset += got;
+    }
+}
+
+
+
+
+
+/*
+ * This function streams a file with --direct-io, double buffered when the reader thread can be
+ * started and chunk by chunk otherwise. It sets *direct to whether O_DIRECT stayed in effect.
+ */
+static int readDirect(const char *path, const IoSink *sink, uint64_t *bytesRead, int *direct) {
+    DirectReader reader = { .direct = 1 };
+    reader.fd = open(path, O_RDONLY | O_CLOEXEC | O_DIRECT);
+    if (reader.fd < 0 && errno == EINVAL) {
+        reader.direct = 0;
+        reader.fd = open(path, O_RDONLY | O_CLOEXEC);
+    }
+    if (reader.fd < 0)
+        return -1;
+
+    void *buffers[2];
+    if (poolAcquire(buffers, 2) != 0) {
+        close(reader.fd);
+        return -1;
+    }
+    reader.buffer[0] = buffers[0];
+    reader.buffer[1] = buffers[1];
+    pthread_mutex_init(&reader.lock, NULL);
+    pthread_cond_init(&reader.changed, NULL);
+
+    int status = 0;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, directReaderThread, &reader) == 0) {
+        for (int slot = 0;; slot ^= 1) {
+            pthread_mutex_lock(&reader.lock);
+            while (!reader.full[slot])
+                pthread_cond_wait(&reader.changed, &reader.lock);
+            ssize_t got = reader.length[slot];
+            pthread_mutex_unlock(&reader.lock);
+            if (got <= 0) {
+                status = got < 0 ? -1 : 0;
+                break;
+            }
+
+            consume(sink, reader.buffer[slot], (size_t)got);
+            *bytesRead += (uint64_t)got;
+
+            pthread_mutex_lock(&reader.lock);
+            reader.full[slot] = 0;
+            pthread_cond_broadcast(&reader.changed);
+            pthread_mutex_unlock(&reader.lock);
+        }
+        pthread_join(thread, NULL);
+    } else {
+        ssize_t got;
+        while ((got = directRead(&reader, reader.buffer[0], (off_t)*bytesRead)) > 0) {
+            consume(sink, reader.buffer[0], (size_t)got);
+            *bytesRead += (uint64_t)got;
+        }
+        status = got < 0 ? -1 : 0;
+    }
+
+    *direct = reader.direct;
+    pthread_cond_destroy(&reader.changed);
+    pthread_mutex_destroy(&reader.lock);
+    poolRelease(buffers, 2);
+    close(reader.fd);
+    return status;
+}
+
+
+
+
+
+/*
+ * This function streams the content of a file into a sink, using the configured I/O strategy (or, in
+ * auto mode, the one that suits the file). Every chunk goes to the analyzer, the content hash and the
+ * tap of the sink alike, so deduplication and the additional analyses cost no extra pass.
+ * With --direct-io the page cache is bypassed (or, where O_DIRECT is rejected, emptied behind the
+ * reader). When profile is given it receives the strategy used, the sampled page-cache residency and
+ * the number of bytes read. It returns 0 on success and -1 if the file could not be opened or read.
+ */
+int readFileContent(const char *path, const IoSink *sink, IoProfile *profile) {
+    IoProfile local = { IO_READ, -1, 0, 0, 0 };
+    if (ioOptions.strategy == IO_DIRECT) {
+        int direct = 0;
+        int status = readDirect(path, sink, &local.bytesRead, &direct);
+        local.strategy = direct ? IO_DIRECT : IO_READ;
+        local.dropBehind = !direct;
+        if (profile)
+            *profile = local;
+        return status;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+
+    IoStrategy strategy = ioOptions.strategy;
+    void *map = MAP_FAILED;
+    if (S_ISREG(st.st_mode) && size > 0 && (strategy == IO_MMAP || (strategy == IO_AUTO && size >= IO_SMALL_FILE))) {
+        map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (strategy == IO_AUTO) {
+            local.residentPercent = map != MAP_FAILED ? sampleResidency(map, size) : probeResidency(fd);
+            strategy = local.residentPercent >= IO_HOT_PERCENT && map != MAP_FAILED ? IO_MMAP : IO_READ;
+        }
+    }
+
+    int status = 0;
+    if (strategy == IO_MMAP && map != MAP_FAILED) {
+        local.strategy = IO_MMAP;
+        madvise(map, size, MADV_SEQUENTIAL);
+        if (ioOptions.hugePages)
+            madvise(map, size, MADV_HUGEPAGE);
+        status = consumeMapped(map, size, sink);
+        local.bytesRead = status == 0 ? size : 0;
+        if (ioOptions.hugePages && profile)
+            local.hugeBytes = poolSmapsRangeBytes(map, size, "FilePmdMapped");
+    } else {
+        local.strategy = IO_READ;
+        status = readSequential(fd, size, sink, &local.bytesRead);
+    }
+
+    if (map != MAP_FAILED)
+        munmap(map, size);
+    close(fd);
+    if (profile)
+        *profile = local;
+    return status;
+}
+
+
+
+
+
+/*
+ * This function streams the content of a file through the analyzer and, when hash is given, the
+ * content hash. ctx may be NULL to only hash the file. It returns 0 on success and -1 if the file
+ * could not be opened or read.
+ */
+int analyzeFileContent(const char *path, clen_ctx *ctx, HashState *hash, IoProfile *profile) {
+    IoSink sink = { ctx, hash, NULL, NULL };
+    return readFileContent(path, &sink, profile);
+}
+
+
+
+
+
+/*
+ * This function produces the result for a file argument. When the context has no metric enabled
+ * beyond the length, only the file size is looked up and the content is never read; otherwise the
+ * content is streamed through the analyzer. The context is reset first, so it can be reused.
+ */
+int analyzeFile(const char *path, clen_ctx *ctx, clen_result *result, IoProfile *profile) {
+    clen_reset(ctx);
+    if (!clen_metrics(ctx)) {
+        memset(result, 0, sizeof(*result));
+        result->length = getFileContentLength(path);
+        return 0;
+    }
+    int status = analyzeFileContent(path, ctx, NULL, profile);
+    clen_finish(ctx, result);
+    return status;
+}
+
+
+
+
+
+/*
+ * This function works like analyzeFile() but also computes the content hash of the file in the same
+ * pass. It always reads the content, even when no metric beyond the length is enabled.
+ */
+int analyzeFileHashed(const char *path, clen_ctx *ctx, clen_result *result, uint64_t *hash, IoProfile *profile) {
+    HashState state;
+    hashInit(&state, 0);
+    clen_reset(ctx);
+    int status = analyzeFileContent(path, ctx, &state, profile);
+    clen_finish(ctx, result);
+    *hash = hashFinal(&state);
+    return status;
+}
+
+
+
+
+
+/*
+ * This function asks the kernel to start reading the first limit bytes of a file into the page cache
+ * in the background, so they are ready by the time the file is analyzed. It returns how many bytes
+ * were requested, or 0 for files that cannot be opened or are not regular files.
+ */
+uint64_t ioPrefetch(const char *path, uint64_t limit) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    uint64_t bytes = 0;
+    if (fd < 0)
+        return 0;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        bytes = (uint64_t)st.st_size < limit ? (uint64_t)st.st_size : limit;
+        if (bytes && posix_fadvise(fd, 0, (off_t)bytes, POSIX_FADV_WILLNEED) != 0)
+            bytes = 0;
+    }
+    close(fd);
+    return bytes;
+}
@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef CLEN_IO_H
+#define CLEN_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "clen.h"
+#include "hash.h"
+
+/*
+ * How file content is read. IO_AUTO picks per file from its size and page-cache residency; IO_DIRECT
+ * bypasses the page cache for cold scans.
+ */
+typedef enum {
+    IO_AUTO,
+    IO_READ,
+    IO_MMAP,
+    IO_DIRECT
+} IoStrategy;
+
+/*
+ * maxReadRate (bytes per second) and maxIops cap how fast files are read, 0 meaning unlimited.
+ */
+typedef struct {
+    IoStrategy strategy;
+    int hugePages;
+    uint64_t maxReadRate;
+    uint64_t maxIops;
+} IoOptions;
+
+/*
+ * What happened while reading one file, for --profile: the strategy actually used, the sampled share
+ * of the file that was in the page cache (-1 when not sampled), the bytes read, and whether the pages
+ * read were dropped from the page cache again because O_DIRECT was not available. With huge pages
+ * requested for a mapped file, hugeBytes tells how much of it was actually mapped with huge pages.
+ */
+typedef struct {
+    IoStrategy strategy;
+    int residentPercent;
+    uint64_t bytesRead;
+    int dropBehind;
+    uint64_t hugeBytes;
+} IoProfile;
+
+/*
+ * Where the content of a file goes while it is read: the analyzer, the content hash and a tap that
+ * sees every chunk as well. Any of them may be NULL.
+ */
+typedef struct {
+    clen_ctx *ctx;
+    HashState *hash;
+    void (*tap)(void *user, const void *data, size_t len);
+    void *user;
+} IoSink;
+
+extern const char *ioStrategyNames[];
+
+void ioSetOptions(const IoOptions *options);
+int ioParseStrategy(const char *name, IoStrategy *strategy);
+void ioThrottle(uint64_t bytes);
+int ioSetIdlePriority(void);
+int isFilePath(const char *path);
+size_t getFileContentLength(const char *path);
+int readFileContent(const char *path, const IoSink *sink, IoProfile *profile);
+int analyzeFileContent(const char *path, clen_ctx *ctx, HashState *hash, IoProfile *profile);
+int analyzeFile(const char *path, clen_ctx *ctx, clen_result *result, IoProfile *profile);
+int analyzeFileHashed(const char *path, clen_ctx *ctx, clen_result *result, uint64_t *hash, IoProfile *profile);
+uint64_t ioPrefetch(const char *path, uint64_t limit);
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <string.h>
+
+#include "lengths.h"
+
+
+
+/*
+ * The sketch is a log-linear histogram like the --latency one, but coarser: with 5 sub-bucket bits
+ * instead of 7, lengths below 32 get a bucket each and every larger power-of-two range is split into 32
+ * linear buckets, so any reported percentile is within 1/32 (about 3%) of the true length while the
+ * whole sketch stays at about 15 KiB. Unlike a t-digest or KLL sketch its error does
+ * not depend on the order or number of inputs, and merging is a plain sum, so per-file sketches can be
+ * combined into run totals without losing anything.
+ */
+
+
+
+
+
+/*
+ * This function empties a sketch.
+ */
+void lengthsClear(LengthSketch *sketch) {
+    memset(sketch, 0, sizeof(*sketch));
+}
+
+
+
+
+
+/*
+ * This function records one length.
+ */
+void lengthsAdd(LengthSketch *sketch, uint64_t length) {
+    sketch->counts[logLinearIndex(length, LENGTHS_SUB_BUCKET_BITS)]++;
+    if (sketch->total == 0 || length < sketch->min)
+        sketch->min = length;
+    if (length > sketch->max)
+        sketch->max = length;
+    sketch->total++;
+    sketch->sum += length;
+}
+
+
+
+
+
+/*
+ * This function adds every length recorded in from to into.
+ */
+void lengthsMerge(LengthSketch *into, const LengthSketch *from) {
+    if (!from->total)
+        return;
+    for (int i = 0; i < LENGTHS_BUCKETS; i++)
+        into->counts[i] += from->counts[i];
+    if (into->total == 0 || from->min < into->min)
+        into->min = from->min;
+    if (from->max > into->max)
+        into->max = from->max;
+    into->total += from->total;
+    into->sum += from->sum;
+}
+
+
+
+
+
+/*
+ * This function returns the mean length, or 0 for an empty sketch.
+ */
+double lengthsMean(const LengthSketch *sketch) {
+    return sketch->total ? (double)sketch->sum / (double)sketch->total : 0;
+}
+
+
+
+
+
+/*
+ * This function returns the length at the given percentile (0-100): the highest length of the bucket
+ * that holds that rank, clamped to the exact minimum and maximum.
+ */
+uint64_t lengthsQuantile(const LengthSketch *sketch, double percentile) {
+    if (sketch->total == 0)
+        return 0;
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)sketch->total + 0.5);
+    if (rank < 1)
+        rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < LENGTHS_BUCKETS; i++) {
+        seen += sketch->counts[i];
+        if (seen >= rank) {
+            uint64_t low, high;
+            logLinearRange(i, LENGTHS_SUB_BUCKET_BITS, &low, &high);
+            return high < sketch->min ? sketch->min : high > sketch->max ? sketch->max : high;
+        }
+    }
+    return sketch->max;
+}
@@ -0,0 +1,56 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_LENGTHS_H
+#define CLEN_LENGTHS_H
+
+#include <stdint.h>
+
+#include "loglinear.h"
+
+#define LENGTHS_SUB_BUCKET_BITS 5
+#define LENGTHS_BUCKETS         LOG_LINEAR_BUCKETS(LENGTHS_SUB_BUCKET_BITS)
+
+/*
+ * The distribution of a stream of lengths (of lines or words) in fixed memory, with exact count, sum,
+ * minimum and maximum. Sketches of separate inputs merge into exactly the sketch of their union.
+ */
+typedef struct {
+    uint64_t counts[LENGTHS_BUCKETS];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} LengthSketch;
+
+void lengthsClear(LengthSketch *sketch);
+void lengthsAdd(LengthSketch *sketch, uint64_t length);
+void lengthsMerge(LengthSketch *into, const LengthSketch *from);
+double lengthsMean(const LengthSketch *sketch);
+uint64_t lengthsQuantile(const LengthSketch *sketch, double percentile);
+
+#endif
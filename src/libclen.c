@@ -0,0 +1,360 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "clen.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+
+#define CLEN_VERSION "1.0.0"
+
+
+
+/*
+ * Every byte value is classified once into a set of class bits, so the analyzer can answer
+ * "is this a letter / digit / whitespace / special sign / sentence ending / quote" with a single
+ * table lookup instead of calling isalpha(), isdigit(), isspace() and strchr() per character.
+ * The classification follows the C locale, which is what the original ctype-based counters used.
+ */
+#define CLASS_UPPER     (1u << 0)
+#define CLASS_LOWER     (1u << 1)
+#define CLASS_DIGIT     (1u << 2)
+#define CLASS_SPACE     (1u << 3)
+#define CLASS_SPECIAL   (1u << 4)
+#define CLASS_SENTENCE  (1u << 5)
+#define CLASS_QUOTE     (1u << 6)
+
+static const uint8_t byteClass[256] = {
+    ['A' ... 'Z'] = CLASS_UPPER,
+    ['a' ... 'z'] = CLASS_LOWER,
+    ['0' ... '9'] = CLASS_DIGIT,
+    [' ']  = CLASS_SPACE, ['\t'] = CLASS_SPACE, ['\n'] = CLASS_SPACE,
+    ['\v'] = CLASS_SPACE, ['\f'] = CLASS_SPACE, ['\r'] = CLASS_SPACE,
+    ['!']  = CLASS_SPECIAL | CLASS_SENTENCE,
+    ['?']  = CLASS_SPECIAL | CLASS_SENTENCE,
+    ['.']  = CLASS_SPECIAL | CLASS_SENTENCE,
+    ['\''] = CLASS_SPECIAL | CLASS_QUOTE,
+    ['"']  = CLASS_SPECIAL | CLASS_QUOTE,
+    ['@'] = CLASS_SPECIAL, ['#'] = CLASS_SPECIAL, ['$'] = CLASS_SPECIAL, ['%'] = CLASS_SPECIAL,
+    ['^'] = CLASS_SPECIAL, ['&'] = CLASS_SPECIAL, ['*'] = CLASS_SPECIAL, ['('] = CLASS_SPECIAL,
+    [')'] = CLASS_SPECIAL, ['-'] = CLASS_SPECIAL, ['_'] = CLASS_SPECIAL, ['='] = CLASS_SPECIAL,
+    ['+'] = CLASS_SPECIAL, ['['] = CLASS_SPECIAL, [']'] = CLASS_SPECIAL, ['{'] = CLASS_SPECIAL,
+    ['}'] = CLASS_SPECIAL, ['|'] = CLASS_SPECIAL, [';'] = CLASS_SPECIAL, [':'] = CLASS_SPECIAL,
+    [','] = CLASS_SPECIAL, ['<'] = CLASS_SPECIAL, ['>'] = CLASS_SPECIAL, ['/'] = CLASS_SPECIAL,
+    ['\\'] = CLASS_SPECIAL, ['~'] = CLASS_SPECIAL, ['`'] = CLASS_SPECIAL,
+};
+
+
+
+/*
+ * The analyzer context holds the running counters plus the little bit of state that has to survive
+ * a chunk boundary: whether the previous byte was inside a word, and the quote matcher state.
+ *
+ * Quotes are matched the way the original counter did it: an opening quote is paired with the next
+ * quote of the same kind, and if it is never closed the scan resumes right after it. Streaming cannot
+ * look ahead, so while a quote is open we also count, speculatively, the pairs formed by the other
+ * quote kind. If the quote closes that speculation is discarded; if the input ends first, those pairs
+ * are exactly what the rescan would have found and they are added by clen_finish().
+ */
+typedef void (*ScanKernel)(clen_ctx *ctx, const unsigned char *p, size_t len);
+
+struct clen_ctx {
+    unsigned metrics;
+    ScanKernel kernel;
+    clen_result counts;
+    int inWord;
+    unsigned char quoteOpen;
+    int quoteSpecOpen;
+    uint64_t quoteSpecCount;
+};
+
+
+
+
+
+/*
+ * This function advances the quote matcher by one quote character.
+ */
+static inline void quoteStep(clen_ctx *ctx, unsigned char c) {
+    if (!ctx->quoteOpen) {
+        ctx->quoteOpen = c;
+    } else if (c == ctx->quoteOpen) {
+        ctx->counts.quotes++;
+        ctx->quoteOpen = 0;
+        ctx->quoteSpecOpen = 0;
+        ctx->quoteSpecCount = 0;
+    } else if (ctx->quoteSpecOpen) {
+        ctx->quoteSpecCount++;
+        ctx->quoteSpecOpen = 0;
+    } else {
+        ctx->quoteSpecOpen = 1;
+    }
+}
+
+
+
+
+
+/*
+ * This function is the fused analysis kernel template. Every enabled metric is computed in the same
+ * single pass over the buffer. It is always inlined with a compile-time constant metric mask, so each
+ * instantiation below keeps only the work for its own metrics and the per-byte "is this metric
+ * enabled" tests disappear from the inner loop.
+ */
+static inline __attribute__((always_inline))
+void scanTemplate(clen_ctx *ctx, const unsigned char *p, size_t len, const unsigned metrics) {
+    uint64_t letters = 0, upper = 0, lower = 0, numbers = 0, sentences = 0, special = 0, words = 0;
+    int inWord = ctx->inWord;
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned cls = byteClass[p[i]];
+        if (metrics & CLEN_METRIC_LETTERS)
+            letters += (cls & (CLASS_UPPER | CLASS_LOWER)) != 0;
+        if (metrics & CLEN_METRIC_CASES) {
+            upper += cls & CLASS_UPPER;
+            lower += (cls & CLASS_LOWER) >> 1;
+        }
+        if (metrics & CLEN_METRIC_NUMBERS)
+            numbers += (cls & CLASS_DIGIT) >> 2;
+        if (metrics & CLEN_METRIC_SENTENCES)
+            sentences += (cls & CLASS_SENTENCE) >> 5;
+        if (metrics & CLEN_METRIC_SPECIAL)
+            special += (cls & CLASS_SPECIAL) >> 4;
+        if (metrics & CLEN_METRIC_WORDS) {
+            int isWord = !(cls & CLASS_SPACE);
+            words += isWord & !inWord;
+            inWord = isWord;
+        }
+        if ((metrics & CLEN_METRIC_QUOTES) && (cls & CLASS_QUOTE))
+            quoteStep(ctx, p[i]);
+    }
+
+    ctx->counts.length    += len;
+    ctx->counts.letters   += letters;
+    ctx->counts.upper     += upper;
+    ctx->counts.lower     += lower;
+    ctx->counts.numbers   += numbers;
+    ctx->counts.sentences += sentences;
+    ctx->counts.special   += special;
+    ctx->counts.words     += words;
+    ctx->inWord = inWord;
+}
+
+
+
+
+
+/*
+ * The specialized kernel family: one instantiation of scanTemplate() per combination of the seven
+ * metric bits, 128 in total. KERNELS_n expands to both halves of the remaining n bits, pasting the
+ * bits onto the function name and shifting them into the mask, so scanKernel0000101 computes mask
+ * 0b0000101 (letters and numbers). KERNEL_TABLE_n walks the same tree to build the dispatch table in
+ * mask order.
+ */
+#define KERNEL(name, mask) \
+    static void scanKernel##name(clen_ctx *ctx, const unsigned char *p, size_t len) { scanTemplate(ctx, p, len, (mask)); }
+#define KERNELS_0(name, mask) KERNEL(name, mask)
+#define KERNELS_1(name, mask) KERNELS_0(name##0, (mask) << 1) KERNELS_0(name##1, ((mask) << 1) | 1)
+#define KERNELS_2(name, mask) KERNELS_1(name##0, (mask) << 1) KERNELS_1(name##1, ((mask) << 1) | 1)
+#define KERNELS_3(name, mask) KERNELS_2(name##0, (mask) << 1) KERNELS_2(name##1, ((mask) << 1) | 1)
+#define KERNELS_4(name, mask) KERNELS_3(name##0, (mask) << 1) KERNELS_3(name##1, ((mask) << 1) | 1)
+#define KERNELS_5(name, mask) KERNELS_4(name##0, (mask) << 1) KERNELS_4(name##1, ((mask) << 1) | 1)
+#define KERNELS_6(name, mask) KERNELS_5(name##0, (mask) << 1) KERNELS_5(name##1, ((mask) << 1) | 1)
+#define KERNELS_7(name, mask) KERNELS_6(name##0, (mask) << 1) KERNELS_6(name##1, ((mask) << 1) | 1)
+
+#define KERNEL_TABLE_0(name) scanKernel##name,
+#define KERNEL_TABLE_1(name) KERNEL_TABLE_0(name##0) KERNEL_TABLE_0(name##1)
+#define KERNEL_TABLE_2(name) KERNEL_TABLE_1(name##0) KERNEL_TABLE_1(name##1)
+#define KERNEL_TABLE_3(name) KERNEL_TABLE_2(name##0) KERNEL_TABLE_2(name##1)
+#define KERNEL_TABLE_4(name) KERNEL_TABLE_3(name##0) KERNEL_TABLE_3(name##1)
+#define KERNEL_TABLE_5(name) KERNEL_TABLE_4(name##0) KERNEL_TABLE_4(name##1)
+#define KERNEL_TABLE_6(name) KERNEL_TABLE_5(name##0) KERNEL_TABLE_5(name##1)
+#define KERNEL_TABLE_7(name) KERNEL_TABLE_6(name##0) KERNEL_TABLE_6(name##1)
+
+KERNELS_7(, 0u)
+
+static const ScanKernel scanKernels[CLEN_METRIC_ALL + 1] = {
+    KERNEL_TABLE_7()
+};
+
+_Static_assert(sizeof(scanKernels) / sizeof(scanKernels[0]) == CLEN_METRIC_ALL + 1,
+               "one specialized kernel per metric combination");
+
+
+
+
+
+clen_ctx *clen_new(unsigned metrics) {
+    clen_ctx *ctx = malloc(sizeof(*ctx));
+    if (!ctx)
+        return NULL;
+    ctx->metrics = metrics & CLEN_METRIC_ALL;
+    ctx->kernel = scanKernels[ctx->metrics];
+    clen_reset(ctx);
+    return ctx;
+}
+
+
+
+
+
+void clen_free(clen_ctx *ctx) {
+    free(ctx);
+}
+
+
+
+
+
+void clen_reset(clen_ctx *ctx) {
+    memset(&ctx->counts, 0, sizeof(ctx->counts));
+    ctx->inWord = 0;
+    ctx->quoteOpen = 0;
+    ctx->quoteSpecOpen = 0;
+    ctx->quoteSpecCount = 0;
+}
+
+
+
+
+
+unsigned clen_metrics(const clen_ctx *ctx) {
+    return ctx->metrics;
+}
+
+
+
+
+
+void clen_feed(clen_ctx *ctx, const void *buf, size_t len) {
+    ctx->kernel(ctx, (const unsigned char *)buf, len);
+}
+
+
+
+
+
+void clen_finish(const clen_ctx *ctx, clen_result *result) {
+    *result = ctx->counts;
+    if (ctx->quoteOpen)
+        result->quotes += ctx->quoteSpecCount;
+}
+
+
+
+
+
+void clen_save(const clen_ctx *ctx, clen_state *state) {
+    memset(state, 0, sizeof(*state));
+    state->counts = ctx->counts;
+    state->inWord = (uint32_t)ctx->inWord;
+    state->quoteOpen = ctx->quoteOpen;
+    state->quoteSpecOpen = (uint32_t)ctx->quoteSpecOpen;
+    state->quoteSpecCount = ctx->quoteSpecCount;
+}
+
+
+
+
+
+void clen_restore(clen_ctx *ctx, const clen_state *state) {
+    ctx->counts = state->counts;
+    ctx->inWord = (int)state->inWord;
+    ctx->quoteOpen = (unsigned char)state->quoteOpen;
+    ctx->quoteSpecOpen = (int)state->quoteSpecOpen;
+    ctx->quoteSpecCount = state->quoteSpecCount;
+}
+
+
+
+
+
+void clen_analyze(unsigned metrics, const void *buf, size_t len, clen_result *result) {
+    clen_ctx ctx;
+    ctx.metrics = metrics & CLEN_METRIC_ALL;
+    ctx.kernel = scanKernels[ctx.metrics];
+    clen_reset(&ctx);
+    clen_feed(&ctx, buf, len);
+    clen_finish(&ctx, result);
+}
+
+
+
+
+
+void clen_merge(clen_result *into, const clen_result *from) {
+    into->length    += from->length;
+    into->letters   += from->letters;
+    into->upper     += from->upper;
+    into->lower     += from->lower;
+    into->numbers   += from->numbers;
+    into->sentences += from->sentences;
+    into->special   += from->special;
+    into->words     += from->words;
+    into->quotes    += from->quotes;
+}
+
+
+
+
+
+void clen_from_histogram(unsigned metrics, const uint64_t histogram[256], clen_result *result) {
+    uint64_t length = 0, upper = 0, lower = 0, numbers = 0, sentences = 0, special = 0;
+    for (int b = 0; b < 256; b++) {
+        uint64_t n = histogram[b];
+        uint8_t cls = byteClass[b];
+        length += n;
+        upper += cls & CLASS_UPPER ? n : 0;
+        lower += cls & CLASS_LOWER ? n : 0;
+        numbers += cls & CLASS_DIGIT ? n : 0;
+        sentences += cls & CLASS_SENTENCE ? n : 0;
+        special += cls & CLASS_SPECIAL ? n : 0;
+    }
+
+    result->length = length;
+    if (metrics & CLEN_METRIC_LETTERS)
+        result->letters = upper + lower;
+    if (metrics & CLEN_METRIC_CASES) {
+        result->upper = upper;
+        result->lower = lower;
+    }
+    if (metrics & CLEN_METRIC_NUMBERS)
+        result->numbers = numbers;
+    if (metrics & CLEN_METRIC_SENTENCES)
+        result->sentences = sentences;
+    if (metrics & CLEN_METRIC_SPECIAL)
+        result->special = special;
+}
+
+
+
+
+
+const char *clen_version(void) {
+    return CLEN_VERSION;
+}
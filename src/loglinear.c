@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include "loglinear.h"
+
+
+
+/*
+ * This function maps a value to its bucket. Values below 2^bits get an exact bucket each; larger
+ * values use their highest set bit to pick the power-of-two range and the following bits bits to pick
+ * the linear sub-bucket inside that range.
+ */
+int logLinearIndex(uint64_t value, int bits) {
+    uint64_t subBuckets = 1ULL << bits;
+    if (value < subBuckets)
+        return (int)value;
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - bits;
+    return (int)((uint64_t)(shift + 1) * subBuckets + ((value >> shift) - subBuckets));
+}
+
+
+
+
+
+/*
+ * This function returns the lowest and highest value that fall into a bucket. It is the exact inverse
+ * of logLinearIndex().
+ */
+void logLinearRange(int index, int bits, uint64_t *low, uint64_t *high) {
+    int subBuckets = 1 << bits;
+    if (index < subBuckets) {
+        *low = *high = (uint64_t)index;
+        return;
+    }
+    int shift = index / subBuckets - 1;
+    uint64_t sub = (uint64_t)(index % subBuckets) + (uint64_t)subBuckets;
+    *low = sub << shift;
+    *high = *low + ((1ULL << shift) - 1);
+}
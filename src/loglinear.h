@@ -0,0 +1,43 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_LOGLINEAR_H
+#define CLEN_LOGLINEAR_H
+
+#include <stdint.h>
+
+/*
+ * Bucket math of the log-linear histograms (--latency, --length-stats): values below 2^bits get a
+ * bucket each, and every larger power-of-two range is split into 2^bits linear sub-buckets, so a bucket
+ * is never wider than 1/2^bits of its values. LOG_LINEAR_BUCKETS(bits) buckets cover all of uint64_t.
+ */
+#define LOG_LINEAR_BUCKETS(bits) ((64 - (bits) + 1) << (bits))
+
+int logLinearIndex(uint64_t value, int bits);
+void logLinearRange(int index, int bits, uint64_t *low, uint64_t *high);
+
+#endif
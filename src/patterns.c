@@ -0,0 +1,335 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "patterns.h"
+
+
+
+/*
+ * The patterns are compiled into an Aho-Corasick automaton whose failure links are resolved ahead of
+ * time, giving a dense DFA: each input byte is exactly one table lookup, whatever the number of
+ * patterns, and the state carries across chunk boundaries. To keep the table small, bytes are first
+ * mapped to classes: every byte that occurs in some pattern has its own class and all other bytes
+ * share class 0, so a state has one row entry per class instead of 256.
+ *
+ * The scan does not follow output links either. It only counts how often each state is entered, and
+ * the per-pattern counts are worked out when they are collected: a pattern ends wherever the current
+ * state's failure chain passes through the pattern's final state, so its count is the sum of the hits
+ * of all states below that state in the failure tree. Occurrences may overlap ("aa" occurs twice in
+ * "aaa").
+ */
+#define PATTERNS_MAX_TABLE (256u << 20)
+
+struct Patterns {
+    char **literals;
+    size_t *lengths;
+    size_t count, capacity;
+    size_t totalBytes;
+    uint16_t classOf[256];
+    uint32_t classes;
+    uint32_t states;
+    uint32_t *delta;
+    uint32_t *fail;
+    uint32_t *order;
+    uint32_t *terminal;
+};
+
+
+
+
+
+/*
+ * This function creates an empty pattern set. Returns NULL when memory cannot be allocated.
+ */
+Patterns *patternsNew(void) {
+    return calloc(1, sizeof(Patterns));
+}
+
+
+
+
+
+/*
+ * This function releases a pattern set. Passing NULL is allowed.
+ */
+void patternsFree(Patterns *patterns) {
+    if (!patterns)
+        return;
+    for (size_t i = 0; i < patterns->count; i++)
+        free(patterns->literals[i]);
+    free(patterns->literals);
+    free(patterns->lengths);
+    free(patterns->delta);
+    free(patterns->fail);
+    free(patterns->order);
+    free(patterns->terminal);
+    free(patterns);
+}
+
+
+
+
+
+/*
+ * This function adds a literal to a set that has not been compiled yet. Empty literals are rejected.
+ * Returns 0 on success or -1.
+ */
+int patternsAdd(Patterns *patterns, const char *literal, size_t len) {
+    if (len == 0 || patterns->delta)
+        return -1;
+    if (patterns->count == patterns->capacity) {
+        size_t capacity = patterns->capacity ? patterns->capacity * 2 : 8;
+        char **literals = realloc(patterns->literals, capacity * sizeof(char *));
+        if (!literals)
+            return -1;
+        patterns->literals = literals;
+        size_t *lengths = realloc(patterns->lengths, capacity * sizeof(size_t));
+        if (!lengths)
+            return -1;
+        patterns->lengths = lengths;
+        patterns->capacity = capacity;
+    }
+    char *copy = malloc(len);
+    if (!copy)
+        return -1;
+    memcpy(copy, literal, len);
+    patterns->literals[patterns->count] = copy;
+    patterns->lengths[patterns->count] = len;
+    patterns->count++;
+    patterns->totalBytes += len;
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function adds every line of a file as a literal, without its line ending. Empty lines are
+ * skipped. Returns 0 on success or -1 if the file cannot be read.
+ */
+int patternsAddFile(Patterns *patterns, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return -1;
+    char *line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    int status = 0;
+    while (status == 0 && (len = getline(&line, &size, file)) >= 0) {
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+            len--;
+        if (len > 0)
+            status = patternsAdd(patterns, line, (size_t)len);
+    }
+    if (ferror(file))
+        status = -1;
+    free(line);
+    fclose(file);
+    return status;
+}
+
+
+
+
+
+/*
+ * This function builds the automaton. Returns 0 on success, or -1 when the set is empty, memory cannot
+ * be allocated or the table would exceed PATTERNS_MAX_TABLE.
+ */
+int patternsCompile(Patterns *patterns) {
+    if (patterns->count == 0 || patterns->delta)
+        return -1;
+
+    uint32_t classes = 1;
+    for (size_t i = 0; i < patterns->count; i++) {
+        const unsigned char *p = (const unsigned char *)patterns->literals[i];
+        for (size_t j = 0; j < patterns->lengths[i]; j++)
+            if (!patterns->classOf[p[j]])
+                patterns->classOf[p[j]] = (uint16_t)classes++;
+    }
+    size_t maxStates = patterns->totalBytes + 1;
+    if (maxStates > UINT32_MAX || maxStates > PATTERNS_MAX_TABLE / sizeof(uint32_t) / classes)
+        return -1;
+
+    uint32_t *delta = calloc(maxStates * classes, sizeof(uint32_t));
+    uint32_t *terminal = malloc(patterns->count * sizeof(uint32_t));
+    if (!delta || !terminal) {
+        free(delta);
+        free(terminal);
+        return -1;
+    }
+
+    // Insert the patterns into a trie whose missing edges are 0, the root
+    uint32_t states = 1;
+    for (size_t i = 0; i < patterns->count; i++) {
+        const unsigned char *p = (const unsigned char *)patterns->literals[i];
+        uint32_t s = 0;
+        for (size_t j = 0; j < patterns->lengths[i]; j++) {
+            uint32_t *edge = &delta[(size_t)s * classes + patterns->classOf[p[j]]];
+            if (!*edge)
+                *edge = states++;
+            s = *edge;
+        }
+        terminal[i] = s;
+    }
+
+    uint32_t *fail = calloc(states, sizeof(uint32_t));
+    uint32_t *order = malloc(states * sizeof(uint32_t));
+    if (!fail || !order) {
+        free(delta);
+        free(terminal);
+        free(fail);
+        free(order);
+        return -1;
+    }
+
+    // Visit the states breadth first, so the failure target of a state is always complete before the
+    // state itself: its trie edges get their failure links, and its missing edges take the transition
+    // of its failure target
+    size_t head = 0, tail = 0;
+    order[tail++] = 0;
+    while (head < tail) {
+        uint32_t s = order[head++];
+        uint32_t *row = &delta[(size_t)s * classes];
+        const uint32_t *fallback = &delta[(size_t)fail[s] * classes];
+        for (uint32_t c = 0; c < classes; c++) {
+            if (row[c]) {
+                fail[row[c]] = s ? fallback[c] : 0;
+                order[tail++] = row[c];
+            } else if (s) {
+                row[c] = fallback[c];
+            }
+        }
+    }
+
+    uint32_t *shrunk = realloc(delta, (size_t)states * classes * sizeof(uint32_t));
+    patterns->delta = shrunk ? shrunk : delta;
+    patterns->classes = classes;
+    patterns->states = states;
+    patterns->fail = fail;
+    patterns->order = order;
+    patterns->terminal = terminal;
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function returns the number of patterns in the set.
+ */
+size_t patternsCount(const Patterns *patterns) {
+    return patterns->count;
+}
+
+
+
+
+
+/*
+ * This function returns pattern index and its length, in the order the patterns were added.
+ */
+const char *patternsGet(const Patterns *patterns, size_t index, size_t *len) {
+    *len = patterns->lengths[index];
+    return patterns->literals[index];
+}
+
+
+
+
+
+/*
+ * This function prepares a scan of one stream with a compiled set. Returns 0 on success or -1 when
+ * memory cannot be allocated.
+ */
+int patternScanInit(PatternScan *scan, const Patterns *patterns) {
+    scan->patterns = patterns;
+    scan->state = 0;
+    scan->hits = calloc(patterns->states, sizeof(uint64_t));
+    return scan->hits ? 0 : -1;
+}
+
+
+
+
+
+/*
+ * This function releases the state of a scan.
+ */
+void patternScanFree(PatternScan *scan) {
+    free(scan->hits);
+    scan->hits = NULL;
+}
+
+
+
+
+
+/*
+ * This function runs the next chunk of the stream through the automaton.
+ */
+void patternScanFeed(PatternScan *scan, const void *data, size_t len) {
+    const unsigned char *p = data;
+    const uint32_t *delta = scan->patterns->delta;
+    const uint16_t *classOf = scan->patterns->classOf;
+    size_t classes = scan->patterns->classes;
+    uint64_t *hits = scan->hits;
+    uint32_t s = scan->state;
+    for (size_t i = 0; i < len; i++) {
+        s = delta[s * classes + classOf[p[i]]];
+        hits[s]++;
+    }
+    scan->state = s;
+}
+
+
+
+
+
+/*
+ * This function ends the stream: it adds the occurrences of every pattern to counts (one entry per
+ * pattern) and resets the scan for the next stream.
+ */
+void patternScanCollect(PatternScan *scan, uint64_t *counts) {
+    const Patterns *patterns = scan->patterns;
+    uint64_t *hits = scan->hits;
+    for (uint32_t i = patterns->states - 1; i > 0; i--) {
+        uint32_t s = patterns->order[i];
+        hits[patterns->fail[s]] += hits[s];
+    }
+    for (size_t i = 0; i < patterns->count; i++)
+        counts[i] += hits[patterns->terminal[i]];
+    memset(hits, 0, patterns->states * sizeof(uint64_t));
+    scan->state = 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_PATTERNS_H
+#define CLEN_PATTERNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A set of literal patterns compiled into one automaton. Patterns are added, then compiled once, and
+ * the compiled set is read-only: any number of PatternScan states can run it, one per stream.
+ */
+typedef struct Patterns Patterns;
+
+typedef struct {
+    const Patterns *patterns;
+    uint32_t state;
+    uint64_t *hits;
+} PatternScan;
+
+Patterns *patternsNew(void);
+void patternsFree(Patterns *patterns);
+int patternsAdd(Patterns *patterns, const char *literal, size_t len);
+int patternsAddFile(Patterns *patterns, const char *path);
+int patternsCompile(Patterns *patterns);
+size_t patternsCount(const Patterns *patterns);
+const char *patternsGet(const Patterns *patterns, size_t index, size_t *len);
+
+int patternScanInit(PatternScan *scan, const Patterns *patterns);
+void patternScanFree(PatternScan *scan);
+void patternScanFeed(PatternScan *scan, const void *data, size_t len);
+void patternScanCollect(PatternScan *scan, uint64_t *counts);
+
+#endif
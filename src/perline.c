@@ -0,0 +1,141 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <string.h>
+
+#include "perline.h"
+
+
+
+/*
+ * Lines are found with memchr(), which the C library vectorizes, and each line is fed to one analyzer
+ * context that is reset between lines, so splitting and analyzing allocate nothing per line. A line
+ * cut by a chunk boundary is simply fed in two parts: the context carries its state across them. The
+ * newline itself is not part of the line, and a last line without one is still reported.
+ */
+
+
+
+
+
+/*
+ * This function prepares a splitter analyzing the metrics in the CLEN_METRIC_* mask. Returns 0 or -1
+ * when memory cannot be allocated.
+ */
+int perLineInit(PerLine *perLine, unsigned metrics, PerLineHandler handler, void *user) {
+    memset(perLine, 0, sizeof(*perLine));
+    perLine->ctx = clen_new(metrics);
+    perLine->handler = handler;
+    perLine->user = user;
+    return perLine->ctx ? 0 : -1;
+}
+
+
+
+
+
+/*
+ * This function releases the splitter's analyzer.
+ */
+void perLineFree(PerLine *perLine) {
+    clen_free(perLine->ctx);
+    perLine->ctx = NULL;
+}
+
+
+
+
+
+/*
+ * This function feeds part of the current line, keeping the first bytes for its preview.
+ */
+static void feedLine(PerLine *perLine, const unsigned char *p, size_t len) {
+    if (!perLine->open) {
+        clen_reset(perLine->ctx);
+        perLine->previewLen = 0;
+        perLine->open = 1;
+    }
+    if (perLine->previewLen < PER_LINE_PREVIEW) {
+        size_t n = PER_LINE_PREVIEW - perLine->previewLen < len ? PER_LINE_PREVIEW - perLine->previewLen : len;
+        memcpy(perLine->preview + perLine->previewLen, p, n);
+        perLine->previewLen += n;
+    }
+    clen_feed(perLine->ctx, p, len);
+}
+
+
+
+
+
+/*
+ * This function reports the current line and closes it.
+ */
+static void endLine(PerLine *perLine) {
+    clen_result result;
+    clen_finish(perLine->ctx, &result);
+    perLine->handler(perLine->user, ++perLine->number, perLine->preview, perLine->previewLen, &result);
+    perLine->open = 0;
+}
+
+
+
+
+
+/*
+ * This function feeds the next chunk of the stream. Its signature matches the tap of an IoSink.
+ */
+void perLineFeed(void *user, const void *data, size_t len) {
+    PerLine *perLine = user;
+    const unsigned char *p = data;
+    const unsigned char *end = p + len;
+    while (p < end) {
+        const unsigned char *newline = memchr(p, '\n', (size_t)(end - p));
+        if (!newline) {
+            feedLine(perLine, p, (size_t)(end - p));
+            break;
+        }
+        feedLine(perLine, p, (size_t)(newline - p));
+        endLine(perLine);
+        p = newline + 1;
+    }
+    if (perLine->tap)
+        perLine->tap(perLine->tapUser, data, len);
+}
+
+
+
+
+
+/*
+ * This function ends the stream, reporting a last line without a newline, and restarts the line
+ * numbers for the next stream.
+ */
+void perLineFinish(PerLine *perLine) {
+    if (perLine->open)
+        endLine(perLine);
+    perLine->number = 0;
+}
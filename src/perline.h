@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_PERLINE_H
+#define CLEN_PERLINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "clen.h"
+
+#define PER_LINE_PREVIEW 8
+
+/*
+ * Receives the result of each line: its number (from 1), up to PER_LINE_PREVIEW bytes from its start
+ * with their count, and the metrics of the line without its newline.
+ */
+typedef void (*PerLineHandler)(void *user, uint64_t number, const char *preview, size_t previewLen, const clen_result *result);
+
+/*
+ * Splits a stream into lines and analyzes every line on its own. Chunks are passed through to tap
+ * afterwards, if set, so other consumers of the stream still see it.
+ */
+typedef struct {
+    clen_ctx *ctx;
+    PerLineHandler handler;
+    void *user;
+    void (*tap)(void *user, const void *data, size_t len);
+    void *tapUser;
+    uint64_t number;
+    int open;
+    char preview[PER_LINE_PREVIEW];
+    size_t previewLen;
+} PerLine;
+
+int perLineInit(PerLine *perLine, unsigned metrics, PerLineHandler handler, void *user);
+void perLineFree(PerLine *perLine);
+void perLineFeed(void *perLine, const void *data, size_t len);
+void perLineFinish(PerLine *perLine);
+
+#endif
@@ -0,0 +1,339 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "pool.h"
+
+
+
+/*
+ * All large I/O buffers of the process come from this pool: fixed-size POOL_BUFFER_SIZE buffers,
+ * aligned for O_DIRECT, that are kept on a free list once released instead of being returned to
+ * malloc. With --max-memory the pool never holds more than the budget; a reader that needs a buffer
+ * while all of them are in use waits until another reader releases one, so more concurrent files
+ * (or daemon requests) slow down instead of growing the process. Without a budget the pool still
+ * reuses buffers but allocates new ones whenever the free list is empty.
+ *
+ * A free buffer stores the free-list link in its own first bytes. Buffers are acquired several at a
+ * time and all at once, so two readers that each need two buffers cannot deadlock holding one each.
+ *
+ * Buffers of other sizes that grow with the input, such as the daemon's request items and replies or a
+ * large --binary-sample, are reserved against the same budget in bytes with poolReserve(). A
+ * reservation never waits: when the budget has no room it fails and the caller gives up or makes do
+ * with less. Reservations also never take the last POOL_MIN_BUFFERS buffers of the budget, so a
+ * daemon worker that holds a reservation while its reader waits for buffers cannot starve the pool.
+ * What stays outside the budget is memory sized by the command line or by options of its own: the
+ * per-argument arrays, stdio's output buffer, and the sketches bounded by --top-words-memory,
+ * --regex-cache and --distinct-precision.
+ *
+ * With --huge-pages the buffers are carved two at a time out of 2 MiB huge pages, which saves TLB
+ * misses on long scans. An explicit MAP_HUGETLB page is tried first; when the system has none
+ * reserved, a 2 MiB-aligned anonymous mapping is marked MADV_HUGEPAGE so transparent huge pages can
+ * back it. The budget is then rounded down to whole huge pages. Chunks are never unmapped, the pool
+ * lives as long as the process.
+ */
+typedef struct PoolNode {
+    struct PoolNode *next;
+} PoolNode;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t released;
+    uint64_t limit;
+    uint64_t allocated;
+    uint64_t inUse;
+    uint64_t peakInUse;
+    uint64_t waits;
+    uint64_t reserved;
+    uint64_t peakReserved;
+    uint64_t refused;
+    int hugePages;
+    uint64_t hugetlbPages;
+    uint64_t transparentPages;
+    PoolNode *freeList;
+} pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, NULL };
+
+
+
+
+
+/*
+ * This function sets the memory budget of the pool in bytes, 0 meaning unlimited, and whether buffers
+ * come from huge pages. Budgets below POOL_MIN_BUFFERS buffers are raised to that, since a
+ * double-buffered reader needs two at once. It must be called before the first buffer is acquired.
+ */
+void poolConfigure(uint64_t maxBytes, int hugePages) {
+    pool.hugePages = hugePages;
+    pool.limit = maxBytes / POOL_BUFFER_SIZE;
+    if (hugePages)
+        pool.limit -= pool.limit % (POOL_HUGE_PAGE / POOL_BUFFER_SIZE);
+    if (maxBytes && pool.limit < POOL_MIN_BUFFERS)
+        pool.limit = POOL_MIN_BUFFERS;
+}
+
+
+
+
+
+/*
+ * This function maps one 2 MiB huge page for the pool, from the reserved huge pages if possible and
+ * otherwise as an aligned region eligible for transparent huge pages. It returns NULL when not even
+ * the anonymous mapping succeeds. Called with the pool lock held.
+ */
+static void *mapHugePage(void) {
+    void *page = mmap(NULL, POOL_HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (page != MAP_FAILED) {
+        pool.hugetlbPages++;
+        return page;
+    }
+
+    char *region = mmap(NULL, 2 * POOL_HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+        return NULL;
+    char *aligned = (char *)(((uintptr_t)region + POOL_HUGE_PAGE - 1) & ~(uintptr_t)(POOL_HUGE_PAGE - 1));
+    if (aligned > region)
+        munmap(region, (size_t)(aligned - region));
+    munmap(aligned + POOL_HUGE_PAGE, (size_t)(region + 2 * POOL_HUGE_PAGE - (aligned + POOL_HUGE_PAGE)));
+    if (madvise(aligned, POOL_HUGE_PAGE, MADV_HUGEPAGE) == 0)
+        pool.transparentPages++;
+    return aligned;
+}
+
+
+
+
+
+/*
+ * This function hands out count buffers, waiting while the budget does not allow them yet. It returns
+ * 0 on success and -1 when the buffers cannot be allocated at all (or could never fit the budget), in
+ * which case the caller falls back to a smaller buffer of its own.
+ */
+int poolAcquire(void **buffers, int count) {
+    pthread_mutex_lock(&pool.lock);
+    if (pool.limit && (uint64_t)count > pool.limit) {
+        pthread_mutex_unlock(&pool.lock);
+        return -1;
+    }
+
+    int waited = 0;
+    while (pool.limit && (pool.inUse + (uint64_t)count) * POOL_BUFFER_SIZE + pool.reserved > pool.limit * POOL_BUFFER_SIZE) {
+        if (!waited++)
+            pool.waits++;
+        pthread_cond_wait(&pool.released, &pool.lock);
+    }
+
+    int got = 0;
+    while (got < count && pool.freeList) {
+        buffers[got++] = pool.freeList;
+        pool.freeList = pool.freeList->next;
+    }
+    for (; got < count; got++) {
+        if (pool.hugePages) {
+            char *page = mapHugePage();
+            if (!page)
+                break;
+            for (size_t offset = POOL_BUFFER_SIZE; offset < POOL_HUGE_PAGE; offset += POOL_BUFFER_SIZE) {
+                PoolNode *node = (PoolNode *)(page + offset);
+                node->next = pool.freeList;
+                pool.freeList = node;
+            }
+            pool.allocated += POOL_HUGE_PAGE / POOL_BUFFER_SIZE;
+            buffers[got] = page;
+            while (got + 1 < count && pool.freeList) {
+                buffers[++got] = pool.freeList;
+                pool.freeList = pool.freeList->next;
+            }
+            continue;
+        }
+        if (posix_memalign(&buffers[got], POOL_BUFFER_ALIGN, POOL_BUFFER_SIZE) != 0)
+            break;
+        pool.allocated++;
+    }
+    pool.inUse += (uint64_t)got;
+    if (pool.inUse > pool.peakInUse)
+        pool.peakInUse = pool.inUse;
+    pthread_mutex_unlock(&pool.lock);
+
+    if (got < count) {
+        poolRelease(buffers, got);
+        return -1;
+    }
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function puts buffers back on the free list and wakes readers waiting for them.
+ */
+void poolRelease(void **buffers, int count) {
+    if (count <= 0)
+        return;
+    pthread_mutex_lock(&pool.lock);
+    for (int i = 0; i < count; i++) {
+        PoolNode *node = buffers[i];
+        node->next = pool.freeList;
+        pool.freeList = node;
+    }
+    pool.inUse -= (uint64_t)count;
+    pthread_cond_broadcast(&pool.released);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+
+
+
+
+/*
+ * This function reserves bytes of the budget for a buffer that does not come from the pool. It returns
+ * 0 when they fit and -1, without waiting, when they do not. Without a budget it always succeeds.
+ */
+int poolReserve(uint64_t bytes) {
+    pthread_mutex_lock(&pool.lock);
+    uint64_t limitBytes = pool.limit * POOL_BUFFER_SIZE;
+    uint64_t floorBytes = (uint64_t)POOL_MIN_BUFFERS * POOL_BUFFER_SIZE;
+    int fits = !pool.limit ||
+               (bytes <= limitBytes - floorBytes - pool.reserved &&
+                pool.reserved + bytes + pool.inUse * POOL_BUFFER_SIZE <= limitBytes);
+    if (fits) {
+        pool.reserved += bytes;
+        if (pool.reserved > pool.peakReserved)
+            pool.peakReserved = pool.reserved;
+    } else {
+        pool.refused++;
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return fits ? 0 : -1;
+}
+
+
+
+
+
+/*
+ * This function returns bytes reserved with poolReserve() to the budget and wakes readers waiting for
+ * room.
+ */
+void poolUnreserve(uint64_t bytes) {
+    if (!bytes)
+        return;
+    pthread_mutex_lock(&pool.lock);
+    pool.reserved -= bytes;
+    pthread_cond_broadcast(&pool.released);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+
+
+
+
+/*
+ * This function reports the budget (in buffers, 0 for unlimited), how many buffers were allocated,
+ * the most that were in use at once, how often a reader had to wait for one, the most bytes reserved
+ * at once and how many reservations were refused, and how many huge pages were mapped explicitly or
+ * advised for transparent huge pages.
+ */
+void poolGetStats(PoolStats *stats) {
+    pthread_mutex_lock(&pool.lock);
+    stats->limitBuffers = pool.limit;
+    stats->allocated = pool.allocated;
+    stats->peakInUse = pool.peakInUse;
+    stats->waits = pool.waits;
+    stats->peakReserved = pool.peakReserved;
+    stats->refused = pool.refused;
+    stats->hugetlbPages = pool.hugetlbPages;
+    stats->transparentPages = pool.transparentPages;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+
+
+
+
+/*
+ * This function reads one field of /proc/self/smaps_rollup, such as "AnonHugePages" or
+ * "FilePmdMapped", and returns it in bytes. Advising MADV_HUGEPAGE does not guarantee huge pages, so
+ * this is how the process finds out whether it actually got them. It returns 0 when the field or the
+ * file is not available.
+ */
+uint64_t poolSmapsBytes(const char *field) {
+    FILE *smaps = fopen("/proc/self/smaps_rollup", "r");
+    if (!smaps)
+        return 0;
+    char line[256];
+    size_t fieldLen = strlen(field);
+    unsigned long long kib = 0;
+    while (fgets(line, sizeof(line), smaps)) {
+        if (strncmp(line, field, fieldLen) == 0 && line[fieldLen] == ':') {
+            sscanf(line + fieldLen + 1, "%llu", &kib);
+            break;
+        }
+    }
+    fclose(smaps);
+    return (uint64_t)kib * 1024;
+}
+
+
+
+
+
+/*
+ * This function is the per-mapping counterpart of poolSmapsBytes(): it sums one field of
+ * /proc/self/smaps over the mappings that overlap [start, start + size), so that the value describes
+ * one mapped file and not the whole process. It returns 0 when the field or the file is not available.
+ */
+uint64_t poolSmapsRangeBytes(const void *start, size_t size, const char *field) {
+    FILE *smaps = fopen("/proc/self/smaps", "r");
+    if (!smaps)
+        return 0;
+    uintptr_t rangeLow = (uintptr_t)start;
+    uintptr_t rangeHigh = rangeLow + size;
+    char line[512];
+    size_t fieldLen = strlen(field);
+    int inside = 0;
+    uint64_t total = 0;
+    while (fgets(line, sizeof(line), smaps)) {
+        unsigned long low, high;
+        if (sscanf(line, "%lx-%lx ", &low, &high) == 2) {
+            inside = low < rangeHigh && high > rangeLow;
+        } else if (inside && strncmp(line, field, fieldLen) == 0 && line[fieldLen] == ':') {
+            unsigned long long kib = 0;
+            sscanf(line + fieldLen + 1, "%llu", &kib);
+            total += (uint64_t)kib * 1024;
+        }
+    }
+    fclose(smaps);
+    return total;
+}
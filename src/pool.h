@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_POOL_H
+#define CLEN_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define POOL_BUFFER_SIZE  (1024 * 1024)
+#define POOL_BUFFER_ALIGN 4096
+#define POOL_MIN_BUFFERS  2
+#define POOL_HUGE_PAGE    (2 * 1024 * 1024)
+
+typedef struct {
+    uint64_t limitBuffers;
+    uint64_t allocated;
+    uint64_t peakInUse;
+    uint64_t waits;
+    uint64_t peakReserved;
+    uint64_t refused;
+    uint64_t hugetlbPages;
+    uint64_t transparentPages;
+} PoolStats;
+
+void poolConfigure(uint64_t maxBytes, int hugePages);
+int poolAcquire(void **buffers, int count);
+void poolRelease(void **buffers, int count);
+int poolReserve(uint64_t bytes);
+void poolUnreserve(uint64_t bytes);
+void poolGetStats(PoolStats *stats);
+uint64_t poolSmapsBytes(const char *field);
+uint64_t poolSmapsRangeBytes(const void *start, size_t size, const char *field);
+
+#endif
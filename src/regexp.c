@@ -0,0 +1,1178 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "regexp.h"
+
+
+
+/*
+ * Regular expressions are parsed into a syntax tree and compiled into a Thompson NFA program, which is
+ * never run by backtracking. Scanning runs a DFA built lazily from it: each DFA state is the set of NFA
+ * instructions that are alive at a point of the line, and a transition is only worked out the first
+ * time the scan needs it. The search is unanchored, so the start instruction joins every state, and
+ * lines are independent: a newline always leads back to the line-start state, and once a line has
+ * matched the scan skips ahead to the next newline with memchr(). ^ and $ hold at the start and end
+ * of a line.
+ *
+ * The DFA lives in a cache of fixed size. When it is full the cache is flushed and rebuilt from the
+ * current state. If it fills up again before the scan made REGEXP_MIN_BYTES_PER_STATE bytes of
+ * progress for every cached state, the expression is too explosive for a DFA to pay off. The scan then
+ * finishes the stream with a plain simulation of the NFA sets, which needs no cache at all but does the
+ * set construction for every byte; the next stream starts over with an empty cache.
+ *
+ * Bytes are mapped to classes that no instruction tells apart, with the newline in a class of its
+ * own, so a DFA state has one transition per class instead of 256.
+ */
+#define REGEXP_MAX_PROGRAM         20000
+#define REGEXP_MAX_EMIT            (4 * REGEXP_MAX_PROGRAM)
+#define REGEXP_MAX_REPEAT          1000
+#define REGEXP_MAX_DEPTH           1000
+#define REGEXP_MIN_BYTES_PER_STATE 16
+
+enum { NODE_EMPTY, NODE_SET, NODE_BOL, NODE_EOL, NODE_CAT, NODE_ALT, NODE_STAR, NODE_PLUS, NODE_QUEST, NODE_REPEAT };
+enum { OP_CHAR, OP_SPLIT, OP_JMP, OP_BOL, OP_EOL, OP_MATCH };
+
+#define STATE_MATCH      1u
+#define STATE_EOL_MATCH  2u
+#define STATE_LINE_START 4u
+
+#define NEXT_UNKNOWN (-1)
+#define NEXT_NEWLINE (-2)
+
+typedef struct {
+    uint64_t bits[4];
+} ByteSet;
+
+typedef struct {
+    int type;
+    int a, b;
+    int min, max;
+} Node;
+
+typedef struct {
+    int op;
+    int arg;
+    int x, y;
+} Inst;
+
+struct Regexp {
+    char *source;
+    Inst *prog;
+    int size;
+    ByteSet *sets;
+    int setCount;
+    uint16_t classOf[256];
+    unsigned char classByte[256];
+    int classes;
+    int newlineClass;
+};
+
+typedef struct {
+    const char *p;
+    const char *error;
+    Node *nodes;
+    int nodeCount, nodeCapacity;
+    ByteSet *sets;
+    int setCount, setCapacity;
+    int depth;
+} Parser;
+
+typedef struct {
+    Inst *prog;
+    int size, capacity;
+    int calls;
+    const Node *nodes;
+} Emitter;
+
+typedef struct {
+    uint32_t offset, count;
+    uint32_t flags;
+    uint32_t hash;
+} DfaState;
+
+struct RegexpScan {
+    const Regexp *re;
+    DfaState *states;
+    int stateCount, maxStates;
+    int32_t *next;
+    int32_t *pcs;
+    size_t pcCount, maxPcs;
+    int32_t *table;
+    size_t tableMask;
+    int32_t *set, *eolSet, *stack;
+    uint32_t *marks;
+    uint32_t generation;
+    int state, lineStart;
+    int skipping;
+    uint64_t lines;
+    uint64_t position, flushPosition;
+    int flushed;
+    int fellBack, thrashed;
+    int32_t *nfaSet;
+    size_t nfaCount;
+    uint32_t nfaFlags;
+};
+
+
+
+
+
+/*
+ * Helpers for the 256-bit byte sets of the parser.
+ */
+static void setAddRange(ByteSet *set, int lo, int hi) {
+    for (int b = lo; b <= hi; b++)
+        set->bits[b >> 6] |= 1ULL << (b & 63);
+}
+
+static int setHas(const ByteSet *set, unsigned char b) {
+    return (set->bits[b >> 6] >> (b & 63)) & 1;
+}
+
+static void setUnion(ByteSet *into, const ByteSet *from, int complement) {
+    for (int i = 0; i < 4; i++)
+        into->bits[i] |= complement ? ~from->bits[i] : from->bits[i];
+}
+
+
+
+
+
+/*
+ * This function appends a node to the syntax tree and returns its index, or -1 when memory runs out.
+ */
+static int newNode(Parser *ps, int type, int a, int b) {
+    if (ps->nodeCount == ps->nodeCapacity) {
+        int capacity = ps->nodeCapacity ? ps->nodeCapacity * 2 : 64;
+        Node *nodes = realloc(ps->nodes, (size_t)capacity * sizeof(Node));
+        if (!nodes) {
+            ps->error = "out of memory";
+            return -1;
+        }
+        ps->nodes = nodes;
+        ps->nodeCapacity = capacity;
+    }
+    ps->nodes[ps->nodeCount] = (Node){ type, a, b, 0, 0 };
+    return ps->nodeCount++;
+}
+
+
+
+
+
+/*
+ * This function turns a byte set into a node. Newlines never take part in a match, since lines are
+ * matched one at a time.
+ */
+static int newSetNode(Parser *ps, ByteSet set) {
+    set.bits['\n' >> 6] &= ~(1ULL << ('\n' & 63));
+    if (ps->setCount == ps->setCapacity) {
+        int capacity = ps->setCapacity ? ps->setCapacity * 2 : 16;
+        ByteSet *sets = realloc(ps->sets, (size_t)capacity * sizeof(ByteSet));
+        if (!sets) {
+            ps->error = "out of memory";
+            return -1;
+        }
+        ps->sets = sets;
+        ps->setCapacity = capacity;
+    }
+    ps->sets[ps->setCount] = set;
+    return newNode(ps, NODE_SET, ps->setCount++, 0);
+}
+
+
+
+
+
+/*
+ * This function adds the bytes of a class escape such as \d or \S to set. Returns 0, or -1 if c does
+ * not name a class.
+ */
+static int classEscape(char c, ByteSet *set) {
+    ByteSet base = {{0}};
+    switch (c == 'D' || c == 'W' || c == 'S' ? c + ('a' - 'A') : c) {
+    case 'd':
+        setAddRange(&base, '0', '9');
+        break;
+    case 'w':
+        setAddRange(&base, '0', '9');
+        setAddRange(&base, 'A', 'Z');
+        setAddRange(&base, 'a', 'z');
+        setAddRange(&base, '_', '_');
+        break;
+    case 's':
+        setAddRange(&base, '\t', '\r');
+        setAddRange(&base, ' ', ' ');
+        break;
+    default:
+        return -1;
+    }
+    setUnion(set, &base, c == 'D' || c == 'W' || c == 'S');
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function reads a single-byte escape after a backslash (\n, \t, \xHH or an escaped punctuation
+ * character), advancing the parser. Returns the byte or -1 with an error set.
+ */
+static int byteEscape(Parser *ps) {
+    unsigned char c = (unsigned char)*ps->p;
+    if (!c) {
+        ps->error = "trailing backslash";
+        return -1;
+    }
+    ps->p++;
+    switch (c) {
+    case 'n': return '\n';
+    case 't': return '\t';
+    case 'r': return '\r';
+    case 'f': return '\f';
+    case 'v': return '\v';
+    case 'x': {
+        int byte = 0;
+        for (int i = 0; i < 2; i++) {
+            unsigned char h = (unsigned char)*ps->p;
+            int digit = h >= '0' && h <= '9' ? h - '0' : h >= 'a' && h <= 'f' ? h - 'a' + 10 : h >= 'A' && h <= 'F' ? h - 'A' + 10 : -1;
+            if (digit < 0) {
+                ps->error = "invalid \\x escape";
+                return -1;
+            }
+            byte = byte * 16 + digit;
+            ps->p++;
+        }
+        return byte;
+    }
+    default:
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+            ps->error = "unsupported escape";
+            return -1;
+        }
+        return c;
+    }
+}
+
+
+
+
+
+/*
+ * This function adds a POSIX class such as [:alpha:] to set, with the parser just past "[:". Returns 0
+ * or -1 with an error set.
+ */
+static int posixClass(Parser *ps, ByteSet *set) {
+    static const struct {
+        const char *name;
+        const char *ranges;
+    } classes[] = {
+        { "alpha", "AZaz" }, { "digit", "09" }, { "alnum", "09AZaz" }, { "upper", "AZ" }, { "lower", "az" },
+        { "space", "\t\r  " }, { "blank", "\t\t  " }, { "punct", "!/:@[`{~" }, { "xdigit", "09AFaf" },
+        { "cntrl", "\x01\x1f\x7f\x7f" }, { "print", " ~" }, { "graph", "!~" },
+    };
+    const char *end = strstr(ps->p, ":]");
+    for (size_t i = 0; end && i < sizeof(classes) / sizeof(classes[0]); i++) {
+        if (strlen(classes[i].name) == (size_t)(end - ps->p) && strncmp(ps->p, classes[i].name, (size_t)(end - ps->p)) == 0) {
+            for (const char *r = classes[i].ranges; *r; r += 2)
+                setAddRange(set, (unsigned char)r[0], (unsigned char)r[1]);
+            ps->p = end + 2;
+            return 0;
+        }
+    }
+    ps->error = "unknown character class";
+    return -1;
+}
+
+
+
+
+
+/*
+ * This function parses a bracket expression, with the parser just past '['.
+ */
+static int parseBracket(Parser *ps) {
+    ByteSet set = {{0}};
+    int negate = *ps->p == '^';
+    if (negate)
+        ps->p++;
+
+    for (int first = 1; first || *ps->p != ']'; first = 0) {
+        if (!*ps->p) {
+            ps->error = "missing ]";
+            return -1;
+        }
+        if (ps->p[0] == '[' && ps->p[1] == ':') {
+            ps->p += 2;
+            if (posixClass(ps, &set) != 0)
+                return -1;
+            continue;
+        }
+        if (ps->p[0] == '\\' && classEscape(ps->p[1], &set) == 0) {
+            ps->p += 2;
+            continue;
+        }
+        int lo = *ps->p == '\\' ? (ps->p++, byteEscape(ps)) : (unsigned char)*ps->p++;
+        int hi = lo;
+        if (lo >= 0 && ps->p[0] == '-' && ps->p[1] && ps->p[1] != ']') {
+            ps->p++;
+            hi = *ps->p == '\\' ? (ps->p++, byteEscape(ps)) : (unsigned char)*ps->p++;
+            if (hi >= 0 && hi < lo) {
+                ps->error = "invalid range";
+                return -1;
+            }
+        }
+        if (lo < 0 || hi < 0)
+            return -1;
+        setAddRange(&set, lo, hi);
+    }
+    ps->p++;
+
+    if (negate) {
+        ByteSet all = set;
+        memset(&set, 0, sizeof(set));
+        setUnion(&set, &all, 1);
+    }
+    return newSetNode(ps, set);
+}
+
+
+
+
+
+static int parseAlternation(Parser *ps);
+
+/*
+ * This function parses a single atom: a group, a bracket expression, '.', an anchor, an escape or a
+ * literal byte.
+ */
+static int parseAtom(Parser *ps) {
+    unsigned char c = (unsigned char)*ps->p++;
+    ByteSet set = {{0}};
+    switch (c) {
+    case '(': {
+        if (++ps->depth > REGEXP_MAX_DEPTH) {
+            ps->error = "nested too deeply";
+            return -1;
+        }
+        int node = parseAlternation(ps);
+        if (node < 0)
+            return -1;
+        if (*ps->p != ')') {
+            ps->error = "missing )";
+            return -1;
+        }
+        ps->p++;
+        ps->depth--;
+        return node;
+    }
+    case '[':
+        return parseBracket(ps);
+    case '.':
+        setAddRange(&set, 0, 255);
+        return newSetNode(ps, set);
+    case '^':
+        return newNode(ps, NODE_BOL, 0, 0);
+    case '$':
+        return newNode(ps, NODE_EOL, 0, 0);
+    case '*':
+    case '+':
+    case '?':
+        ps->error = "nothing to repeat";
+        return -1;
+    case '\\': {
+        if (classEscape(*ps->p, &set) == 0) {
+            ps->p++;
+            return newSetNode(ps, set);
+        }
+        int byte = byteEscape(ps);
+        if (byte < 0)
+            return -1;
+        setAddRange(&set, byte, byte);
+        return newSetNode(ps, set);
+    }
+    default:
+        setAddRange(&set, c, c);
+        return newSetNode(ps, set);
+    }
+}
+
+
+
+
+
+/*
+ * This function reads the bounds of {m}, {m,} or {m,n}, with the parser at '{'. Returns 1 and advances
+ * past '}' for a valid bound, 0 when the brace is not a bound (it is then a literal), or -1 with an
+ * error set for bounds that are out of order or too large.
+ */
+static int parseBounds(Parser *ps, int *min, int *max) {
+    const char *p = ps->p + 1;
+    if (*p < '0' || *p > '9')
+        return 0;
+    long lo = strtol(p, (char **)&p, 10), hi = lo;
+    if (*p == ',') {
+        p++;
+        hi = *p >= '0' && *p <= '9' ? strtol(p, (char **)&p, 10) : -1;
+    }
+    if (*p != '}')
+        return 0;
+    if (lo > REGEXP_MAX_REPEAT || hi > REGEXP_MAX_REPEAT || (hi >= 0 && hi < lo)) {
+        ps->error = "invalid repetition bounds";
+        return -1;
+    }
+    ps->p = p + 1;
+    *min = (int)lo;
+    *max = (int)hi;
+    return 1;
+}
+
+
+
+
+
+/*
+ * This function parses an atom followed by any number of *, +, ? or {m,n} operators.
+ */
+static int parseRepeat(Parser *ps) {
+    int node = parseAtom(ps);
+    while (node >= 0) {
+        char c = *ps->p;
+        int min, max, bounds;
+        if (c == '*' || c == '+' || c == '?') {
+            ps->p++;
+            node = newNode(ps, c == '*' ? NODE_STAR : c == '+' ? NODE_PLUS : NODE_QUEST, node, 0);
+        } else if (c == '{' && (bounds = parseBounds(ps, &min, &max)) != 0) {
+            if (bounds < 0)
+                return -1;
+            node = newNode(ps, NODE_REPEAT, node, 0);
+            if (node >= 0) {
+                ps->nodes[node].min = min;
+                ps->nodes[node].max = max;
+            }
+        } else
+            break;
+    }
+    return node;
+}
+
+
+
+
+
+/*
+ * This function parses a sequence of repeated atoms, up to '|', ')' or the end of the pattern.
+ */
+static int parseConcatenation(Parser *ps) {
+    int node = newNode(ps, NODE_EMPTY, 0, 0);
+    while (node >= 0 && *ps->p && *ps->p != '|' && *ps->p != ')') {
+        int next = parseRepeat(ps);
+        if (next < 0)
+            return -1;
+        node = ps->nodes[node].type == NODE_EMPTY ? next : newNode(ps, NODE_CAT, node, next);
+    }
+    return node;
+}
+
+
+
+
+
+/*
+ * This function parses alternatives separated by '|'.
+ */
+static int parseAlternation(Parser *ps) {
+    int node = parseConcatenation(ps);
+    while (node >= 0 && *ps->p == '|') {
+        ps->p++;
+        int next = parseConcatenation(ps);
+        if (next < 0)
+            return -1;
+        node = newNode(ps, NODE_ALT, node, next);
+    }
+    return node;
+}
+
+
+
+
+
+/*
+ * This function appends one instruction to the program and returns its address, or -1 when the program
+ * would grow beyond REGEXP_MAX_PROGRAM.
+ */
+static int emitInst(Emitter *e, int op, int arg, int x, int y) {
+    if (e->size == REGEXP_MAX_PROGRAM)
+        return -1;
+    if (e->size == e->capacity) {
+        int capacity = e->capacity ? e->capacity * 2 : 64;
+        Inst *prog = realloc(e->prog, (size_t)capacity * sizeof(Inst));
+        if (!prog)
+            return -1;
+        e->prog = prog;
+        e->capacity = capacity;
+    }
+    e->prog[e->size] = (Inst){ op, arg, x, y };
+    return e->size++;
+}
+
+
+
+
+
+static int emit(Emitter *e, int node);
+
+/*
+ * These functions emit the loop of a*, and the optional branch of a?.
+ */
+static int emitStar(Emitter *e, int node) {
+    int split = emitInst(e, OP_SPLIT, 0, e->size + 1, 0);
+    if (split < 0 || emit(e, node) < 0 || emitInst(e, OP_JMP, 0, split, 0) < 0)
+        return -1;
+    e->prog[split].y = e->size;
+    return 0;
+}
+
+static int emitQuest(Emitter *e, int node) {
+    int split = emitInst(e, OP_SPLIT, 0, e->size + 1, 0);
+    if (split < 0 || emit(e, node) < 0)
+        return -1;
+    e->prog[split].y = e->size;
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function compiles a syntax tree node into NFA instructions. Returns 0 or -1. Every call counts
+ * against REGEXP_MAX_EMIT, so nested repeats of something that emits nothing, such as (){1000}{1000},
+ * are refused instead of expanding for ages without ever reaching REGEXP_MAX_PROGRAM.
+ */
+static int emit(Emitter *e, int index) {
+    const Node *node = &e->nodes[index];
+    if (++e->calls > REGEXP_MAX_EMIT)
+        return -1;
+    switch (node->type) {
+    case NODE_EMPTY:
+        return 0;
+    case NODE_SET:
+        return emitInst(e, OP_CHAR, node->a, e->size + 1, 0) < 0 ? -1 : 0;
+    case NODE_BOL:
+    case NODE_EOL:
+        return emitInst(e, node->type == NODE_BOL ? OP_BOL : OP_EOL, 0, e->size + 1, 0) < 0 ? -1 : 0;
+    case NODE_CAT:
+        return emit(e, node->a) < 0 || emit(e, node->b) < 0 ? -1 : 0;
+    case NODE_ALT: {
+        int split = emitInst(e, OP_SPLIT, 0, e->size + 1, 0);
+        if (split < 0 || emit(e, node->a) < 0)
+            return -1;
+        int jump = emitInst(e, OP_JMP, 0, 0, 0);
+        if (jump < 0)
+            return -1;
+        e->prog[split].y = e->size;
+        if (emit(e, node->b) < 0)
+            return -1;
+        e->prog[jump].x = e->size;
+        return 0;
+    }
+    case NODE_STAR:
+        return emitStar(e, node->a);
+    case NODE_PLUS: {
+        int start = e->size;
+        if (emit(e, node->a) < 0)
+            return -1;
+        return emitInst(e, OP_SPLIT, 0, start, e->size + 1) < 0 ? -1 : 0;
+    }
+    case NODE_QUEST:
+        return emitQuest(e, node->a);
+    default: {
+        for (int i = 0; i < node->min; i++)
+            if (emit(e, node->a) < 0)
+                return -1;
+        if (node->max < 0)
+            return emitStar(e, node->a);
+        for (int i = node->min; i < node->max; i++)
+            if (emitQuest(e, node->a) < 0)
+                return -1;
+        return 0;
+    }
+    }
+}
+
+
+
+
+
+/*
+ * This function splits every byte class into the bytes inside and outside of set.
+ */
+static void refineClasses(Regexp *re, const ByteSet *set) {
+    int map[2][256];
+    memset(map, -1, sizeof(map));
+    int classes = 0;
+    for (int b = 0; b < 256; b++) {
+        int *slot = &map[setHas(set, (unsigned char)b)][re->classOf[b]];
+        if (*slot < 0)
+            *slot = classes++;
+        re->classOf[b] = (uint16_t)*slot;
+    }
+    re->classes = classes;
+}
+
+
+
+
+
+/*
+ * This function compiles a pattern. Returns NULL and points *error at a description when the pattern
+ * is invalid, too large or memory runs out.
+ */
+Regexp *regexpCompile(const char *pattern, const char **error) {
+    Parser ps = { pattern, NULL, NULL, 0, 0, NULL, 0, 0, 0 };
+    int root = parseAlternation(&ps);
+    if (root >= 0 && *ps.p) {
+        ps.error = "unmatched )";
+        root = -1;
+    }
+
+    Regexp *re = root >= 0 ? calloc(1, sizeof(Regexp)) : NULL;
+    Emitter e = { NULL, 0, 0, 0, ps.nodes };
+    if (re && (emit(&e, root) < 0 || emitInst(&e, OP_MATCH, 0, 0, 0) < 0)) {
+        ps.error = "pattern too large";
+        free(re);
+        re = NULL;
+    }
+    if (re)
+        re->source = strdup(pattern);
+    if (!re || !re->source) {
+        *error = ps.error ? ps.error : "out of memory";
+        free(ps.nodes);
+        free(ps.sets);
+        free(e.prog);
+        if (re)
+            free(re);
+        return NULL;
+    }
+    free(ps.nodes);
+
+    re->prog = e.prog;
+    re->size = e.size;
+    re->sets = ps.sets;
+    re->setCount = ps.setCount;
+    re->classes = 1;
+    ByteSet newline = {{0}};
+    setAddRange(&newline, '\n', '\n');
+    refineClasses(re, &newline);
+    for (int i = 0; i < re->setCount; i++)
+        refineClasses(re, &re->sets[i]);
+    for (int b = 255; b >= 0; b--)
+        re->classByte[re->classOf[b]] = (unsigned char)b;
+    re->newlineClass = re->classOf['\n'];
+    return re;
+}
+
+
+
+
+
+/*
+ * This function releases a compiled expression. Passing NULL is allowed.
+ */
+void regexpFree(Regexp *re) {
+    if (!re)
+        return;
+    free(re->source);
+    free(re->prog);
+    free(re->sets);
+    free(re);
+}
+
+
+
+
+
+/*
+ * This function returns the pattern an expression was compiled from.
+ */
+const char *regexpSource(const Regexp *re) {
+    return re->source;
+}
+
+
+
+
+
+/*
+ * This function starts a new generation of the closure marks, so every instruction can be added to a
+ * set once more.
+ */
+static void newGeneration(RegexpScan *scan) {
+    if (++scan->generation == 0) {
+        memset(scan->marks, 0, (size_t)scan->re->size * sizeof(uint32_t));
+        scan->generation = 1;
+    }
+}
+
+
+
+
+
+/*
+ * This function adds the instructions reachable from pc without consuming input to out, which holds n
+ * of them, and returns the new count. Only instructions that wait for something are kept: bytes, the
+ * match, and end-of-line anchors unless the line is known to end here.
+ */
+static size_t closure(RegexpScan *scan, int pc, int lineStart, int lineEnd, int32_t *out, size_t n) {
+    const Inst *prog = scan->re->prog;
+    int32_t *stack = scan->stack;
+    size_t depth = 0;
+    if (scan->marks[pc] != scan->generation) {
+        scan->marks[pc] = scan->generation;
+        stack[depth++] = pc;
+    }
+    while (depth) {
+        const Inst *inst = &prog[stack[--depth]];
+        int follow[2], count = 0;
+        switch (inst->op) {
+        case OP_JMP:
+            follow[count++] = inst->x;
+            break;
+        case OP_SPLIT:
+            follow[count++] = inst->y;
+            follow[count++] = inst->x;
+            break;
+        case OP_BOL:
+            if (lineStart)
+                follow[count++] = inst->x;
+            break;
+        case OP_EOL:
+            if (lineEnd)
+                follow[count++] = inst->x;
+            else
+                out[n++] = (int32_t)(inst - prog);
+            break;
+        default:
+            out[n++] = (int32_t)(inst - prog);
+        }
+        for (int i = 0; i < count; i++) {
+            if (scan->marks[follow[i]] != scan->generation) {
+                scan->marks[follow[i]] = scan->generation;
+                stack[depth++] = follow[i];
+            }
+        }
+    }
+    return n;
+}
+
+
+
+
+
+static int comparePc(const void *a, const void *b) {
+    return *(const int32_t *)a - *(const int32_t *)b;
+}
+
+/*
+ * This function computes the set that follows in after one byte of class cls, including a new match
+ * attempt starting at the next byte. Sets that become DFA states are sorted, so equal sets compare
+ * equal; the NFA simulation does not need that.
+ */
+static size_t stepSet(RegexpScan *scan, const int32_t *in, size_t n, int cls, int32_t *out, int sort) {
+    const Regexp *re = scan->re;
+    unsigned char byte = re->classByte[cls];
+    size_t m = 0;
+    newGeneration(scan);
+    for (size_t i = 0; i < n; i++) {
+        const Inst *inst = &re->prog[in[i]];
+        if (inst->op == OP_CHAR && setHas(&re->sets[inst->arg], byte))
+            m = closure(scan, inst->x, 0, 0, out, m);
+    }
+    m = closure(scan, 0, 0, 0, out, m);
+    if (sort)
+        qsort(out, m, sizeof(int32_t), comparePc);
+    return m;
+}
+
+/*
+ * This function computes the set at the start of a line.
+ */
+static size_t startSet(RegexpScan *scan, int32_t *out) {
+    newGeneration(scan);
+    size_t m = closure(scan, 0, 1, 0, out, 0);
+    qsort(out, m, sizeof(int32_t), comparePc);
+    return m;
+}
+
+
+
+
+
+/*
+ * This function works out the flags of a set: whether it has matched, and whether it matches if the
+ * line ends right here.
+ */
+static uint32_t setFlags(RegexpScan *scan, const int32_t *set, size_t n, int lineStart) {
+    const Inst *prog = scan->re->prog;
+    uint32_t flags = lineStart ? STATE_LINE_START : 0;
+    for (size_t i = 0; i < n; i++)
+        if (prog[set[i]].op == OP_MATCH)
+            return flags | STATE_MATCH;
+
+    size_t m = 0;
+    newGeneration(scan);
+    for (size_t i = 0; i < n; i++)
+        if (prog[set[i]].op == OP_EOL)
+            m = closure(scan, prog[set[i]].x, lineStart, 1, scan->eolSet, m);
+    for (size_t i = 0; i < m; i++)
+        if (prog[scan->eolSet[i]].op == OP_MATCH)
+            return flags | STATE_EOL_MATCH;
+    return flags;
+}
+
+
+
+
+
+/*
+ * This function empties the DFA cache.
+ */
+static void flushCache(RegexpScan *scan) {
+    scan->stateCount = 0;
+    scan->pcCount = 0;
+    memset(scan->table, -1, (scan->tableMask + 1) * sizeof(int32_t));
+}
+
+
+
+
+
+/*
+ * This function returns the DFA state for a set, adding it to the cache when it is new. Returns -1
+ * when the cache is full.
+ */
+static int findState(RegexpScan *scan, const int32_t *set, size_t n, uint32_t flags) {
+    uint32_t hash = 2166136261u ^ flags;
+    for (size_t i = 0; i < n; i++)
+        hash = (hash ^ (uint32_t)set[i]) * 16777619u;
+
+    size_t slot = hash & scan->tableMask;
+    for (int32_t id; (id = scan->table[slot]) >= 0; slot = (slot + 1) & scan->tableMask) {
+        const DfaState *state = &scan->states[id];
+        if (state->hash == hash && state->flags == flags && state->count == n &&
+            memcmp(scan->pcs + state->offset, set, n * sizeof(int32_t)) == 0)
+            return id;
+    }
+    if (scan->stateCount == scan->maxStates || scan->pcCount + n > scan->maxPcs)
+        return -1;
+
+    int id = scan->stateCount++;
+    scan->states[id] = (DfaState){ (uint32_t)scan->pcCount, (uint32_t)n, flags, hash };
+    memcpy(scan->pcs + scan->pcCount, set, n * sizeof(int32_t));
+    scan->pcCount += n;
+    int32_t *row = scan->next + (size_t)id * scan->re->classes;
+    for (int c = 0; c < scan->re->classes; c++)
+        row[c] = NEXT_UNKNOWN;
+    row[scan->re->newlineClass] = NEXT_NEWLINE;
+    scan->table[slot] = id;
+    return id;
+}
+
+
+
+
+
+/*
+ * This function adds the line-start state to the cache, which always has room for it.
+ */
+static void addLineStart(RegexpScan *scan) {
+    size_t n = startSet(scan, scan->set);
+    scan->lineStart = findState(scan, scan->set, n, setFlags(scan, scan->set, n, 1));
+}
+
+
+
+
+
+/*
+ * This function works out a missing transition of the DFA, at stream position position. When the cache
+ * is full it is flushed, or, if it filled up too fast, the scan switches to NFA simulation from the
+ * resulting set and -1 is returned.
+ */
+static int computeNext(RegexpScan *scan, int from, int cls, uint64_t position) {
+    const DfaState *state = &scan->states[from];
+    size_t n = stepSet(scan, scan->pcs + state->offset, state->count, cls, scan->set, 1);
+    uint32_t flags = setFlags(scan, scan->set, n, 0);
+    int id = findState(scan, scan->set, n, flags);
+    if (id >= 0) {
+        scan->next[(size_t)from * scan->re->classes + cls] = id;
+        return id;
+    }
+
+    if (scan->flushed && position - scan->flushPosition < (uint64_t)scan->stateCount * REGEXP_MIN_BYTES_PER_STATE) {
+        memcpy(scan->nfaSet, scan->set, n * sizeof(int32_t));
+        scan->nfaCount = n;
+        scan->nfaFlags = flags;
+        scan->fellBack = 1;
+        scan->thrashed = 1;
+        return -1;
+    }
+    flushCache(scan);
+    scan->flushed = 1;
+    scan->flushPosition = position;
+    memcpy(scan->nfaSet, scan->set, n * sizeof(int32_t));
+    addLineStart(scan);
+    return findState(scan, scan->nfaSet, n, flags);
+}
+
+
+
+
+
+/*
+ * This function resets the NFA simulation to the start of a line.
+ */
+static void nfaLineStart(RegexpScan *scan) {
+    scan->nfaCount = startSet(scan, scan->nfaSet);
+    scan->nfaFlags = setFlags(scan, scan->nfaSet, scan->nfaCount, 1);
+}
+
+
+
+
+
+/*
+ * This function prepares a scan with a DFA cache of about cacheBytes. Returns NULL when memory cannot
+ * be allocated.
+ */
+RegexpScan *regexpScanNew(const Regexp *re, size_t cacheBytes) {
+    RegexpScan *scan = calloc(1, sizeof(RegexpScan));
+    if (!scan)
+        return NULL;
+    scan->re = re;
+    size_t stateBytes = (size_t)re->classes * sizeof(int32_t) + sizeof(DfaState) + 2 * sizeof(int32_t);
+    scan->maxStates = (int)(cacheBytes / 2 / stateBytes < 16 ? 16 : cacheBytes / 2 / stateBytes > INT32_MAX / 2 ? INT32_MAX / 2 : cacheBytes / 2 / stateBytes);
+    scan->maxPcs = cacheBytes / 2 / sizeof(int32_t);
+    if (scan->maxPcs < (size_t)re->size * 4)
+        scan->maxPcs = (size_t)re->size * 4;
+    size_t tableSize = 1;
+    while (tableSize < (size_t)scan->maxStates * 2)
+        tableSize <<= 1;
+    scan->tableMask = tableSize - 1;
+
+    scan->states = malloc((size_t)scan->maxStates * sizeof(DfaState));
+    scan->next = malloc((size_t)scan->maxStates * re->classes * sizeof(int32_t));
+    scan->pcs = malloc(scan->maxPcs * sizeof(int32_t));
+    scan->table = malloc(tableSize * sizeof(int32_t));
+    scan->set = malloc((size_t)re->size * sizeof(int32_t));
+    scan->eolSet = malloc((size_t)re->size * sizeof(int32_t));
+    scan->stack = malloc((size_t)re->size * sizeof(int32_t));
+    scan->nfaSet = malloc((size_t)re->size * sizeof(int32_t));
+    scan->marks = calloc((size_t)re->size, sizeof(uint32_t));
+    if (!scan->states || !scan->next || !scan->pcs || !scan->table || !scan->set || !scan->eolSet ||
+        !scan->stack || !scan->nfaSet || !scan->marks) {
+        regexpScanFree(scan);
+        return NULL;
+    }
+
+    flushCache(scan);
+    addLineStart(scan);
+    scan->state = scan->lineStart;
+    return scan;
+}
+
+
+
+
+
+/*
+ * This function releases a scan. Passing NULL is allowed.
+ */
+void regexpScanFree(RegexpScan *scan) {
+    if (!scan)
+        return;
+    free(scan->states);
+    free(scan->next);
+    free(scan->pcs);
+    free(scan->table);
+    free(scan->set);
+    free(scan->eolSet);
+    free(scan->stack);
+    free(scan->nfaSet);
+    free(scan->marks);
+    free(scan);
+}
+
+
+
+
+
+/*
+ * This function runs the DFA over p..end and returns where it stopped: at end, or just past the byte
+ * after which the scan fell back to NFA simulation.
+ */
+static const unsigned char *feedDfa(RegexpScan *scan, const unsigned char *p, const unsigned char *end, const unsigned char *start) {
+    const uint16_t *classOf = scan->re->classOf;
+    size_t classes = (size_t)scan->re->classes;
+    int s = scan->state;
+    while (p < end) {
+        if (scan->skipping) {
+            const unsigned char *newline = memchr(p, '\n', (size_t)(end - p));
+            if (!newline) {
+                p = end;
+                break;
+            }
+            p = newline + 1;
+            scan->skipping = 0;
+            s = scan->lineStart;
+            continue;
+        }
+        if (scan->states[s].flags & STATE_MATCH) {
+            scan->lines++;
+            scan->skipping = 1;
+            continue;
+        }
+        int32_t t = scan->next[(size_t)s * classes + classOf[*p]];
+        if (t >= 0) {
+            s = t;
+            p++;
+            continue;
+        }
+        if (t == NEXT_NEWLINE) {
+            if (scan->states[s].flags & STATE_EOL_MATCH)
+                scan->lines++;
+            s = scan->lineStart;
+            p++;
+            continue;
+        }
+        t = computeNext(scan, s, classOf[*p], scan->position + (uint64_t)(p - start));
+        p++;
+        if (t < 0)
+            return p;
+        s = t;
+    }
+    scan->state = s;
+    return p;
+}
+
+
+
+
+
+/*
+ * This function runs the NFA simulation over p..end.
+ */
+static void feedNfa(RegexpScan *scan, const unsigned char *p, const unsigned char *end) {
+    while (p < end) {
+        if (scan->skipping) {
+            const unsigned char *newline = memchr(p, '\n', (size_t)(end - p));
+            if (!newline)
+                return;
+            p = newline + 1;
+            scan->skipping = 0;
+            nfaLineStart(scan);
+            continue;
+        }
+        if (scan->nfaFlags & STATE_MATCH) {
+            scan->lines++;
+            scan->skipping = 1;
+            continue;
+        }
+        if (*p == '\n') {
+            if (scan->nfaFlags & STATE_EOL_MATCH)
+                scan->lines++;
+            nfaLineStart(scan);
+            p++;
+            continue;
+        }
+        size_t n = stepSet(scan, scan->nfaSet, scan->nfaCount, scan->re->classOf[*p++], scan->set, 0);
+        int32_t *swap = scan->nfaSet;
+        scan->nfaSet = scan->set;
+        scan->set = swap;
+        scan->nfaCount = n;
+        scan->nfaFlags = setFlags(scan, scan->nfaSet, n, 0);
+    }
+}
+
+
+
+
+
+/*
+ * This function feeds the next chunk of the stream. Lines may be split at any byte boundary.
+ */
+void regexpScanFeed(RegexpScan *scan, const void *data, size_t len) {
+    const unsigned char *start = data, *p = start;
+    if (!scan->fellBack)
+        p = feedDfa(scan, p, start + len, start);
+    if (scan->fellBack)
+        feedNfa(scan, p, start + len);
+    scan->position += len;
+}
+
+
+
+
+
+/*
+ * This function ends the stream, counting a last line without a newline, and returns the number of
+ * lines that matched. The scan is reset for the next stream; the DFA cache is kept, unless the stream
+ * fell back to NFA simulation, in which case the next stream gets a fresh cache.
+ */
+uint64_t regexpScanFinish(RegexpScan *scan) {
+    uint32_t flags = scan->fellBack ? scan->nfaFlags : scan->states[scan->state].flags;
+    if (!scan->skipping && !(flags & STATE_LINE_START) && (flags & (STATE_MATCH | STATE_EOL_MATCH)))
+        scan->lines++;
+    uint64_t lines = scan->lines;
+    scan->lines = 0;
+    scan->skipping = 0;
+    if (scan->fellBack) {
+        flushCache(scan);
+        addLineStart(scan);
+        scan->flushed = 0;
+        scan->fellBack = 0;
+    }
+    scan->state = scan->lineStart;
+    return lines;
+}
+
+
+
+
+
+/*
+ * This function tells whether the DFA cache thrashed in any stream so far, so that stream finished with
+ * NFA simulation.
+ */
+int regexpScanFellBack(const RegexpScan *scan) {
+    return scan->thrashed;
+}
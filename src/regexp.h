@@ -0,0 +1,54 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_REGEXP_H
+#define CLEN_REGEXP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define REGEXP_DEFAULT_CACHE (1u << 20)
+
+/*
+ * A compiled regular expression (POSIX ERE syntax, without back-references) and a scan that counts the
+ * lines of a stream it matches, like grep -c. The compiled expression is read-only and can be shared;
+ * every stream gets its own scan, which holds the lazily built DFA.
+ */
+typedef struct Regexp Regexp;
+typedef struct RegexpScan RegexpScan;
+
+Regexp *regexpCompile(const char *pattern, const char **error);
+void regexpFree(Regexp *re);
+const char *regexpSource(const Regexp *re);
+
+RegexpScan *regexpScanNew(const Regexp *re, size_t cacheBytes);
+void regexpScanFree(RegexpScan *scan);
+void regexpScanFeed(RegexpScan *scan, const void *data, size_t len);
+uint64_t regexpScanFinish(RegexpScan *scan);
+int regexpScanFellBack(const RegexpScan *scan);
+
+#endif
@@ -0,0 +1,439 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "serve.h"
+#include "io.h"
+#include "cpu.h"
+#include "pool.h"
+
+
+
+/*
+ * The daemon speaks a small framed binary protocol over a Unix domain socket. Client and daemon always
+ * run on the same host, so all fields use the native byte order.
+ *
+ * A request is a ServeHeader (count items, metrics = CLEN_METRIC_* mask) followed by count items, each a
+ * ServeItem followed by length bytes of data. A text item is analyzed as-is; a path item names a file
+ * whose content the daemon streams through the analyzer. The daemon answers with a ServeHeader
+ * (status 0 on success) followed by count ServeReply records in request order. A connection can carry
+ * any number of request/response frames; the daemon closes it on the first malformed frame.
+ */
+#define SERVE_MAGIC          0x4E454C43u
+#define SERVE_VERSION        1
+#define SERVE_MAX_ITEMS      65536u
+#define SERVE_MAX_ITEM_BYTES (64u << 20)
+
+#define SERVE_ITEM_TEXT      0
+#define SERVE_ITEM_PATH      1
+
+#define SERVE_STATUS_OK      0
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t status;
+    uint32_t metrics;
+    uint32_t count;
+} ServeHeader;
+
+typedef struct {
+    uint32_t kind;
+    uint32_t length;
+} ServeItem;
+
+static char serveSocketPath[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static int serveListenFd = -1;
+
+
+
+
+
+/*
+ * These two helpers transfer exactly len bytes over a socket, retrying on short transfers and EINTR.
+ * They return 0 on success and -1 on error or when the peer closed the connection. Writes use
+ * MSG_NOSIGNAL, so a peer that went away fails the write with EPIPE instead of raising SIGPIPE.
+ */
+static int readFull(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len) {
+        ssize_t got = read(fd, p, len);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return -1;
+        p += got;
+        len -= (size_t)got;
+    }
+    return 0;
+}
+
+static int writeFull(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len) {
+        ssize_t put = send(fd, p, len, MSG_NOSIGNAL);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0)
+            return -1;
+        p += put;
+        len -= (size_t)put;
+    }
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function grows a buffer to at least size bytes, reserving the growth against the memory budget
+ * first. It returns 0 on success and -1 when the budget has no room or memory runs out; the buffer is
+ * then left as it was.
+ */
+static int growReserved(void **buffer, size_t *capacity, size_t size) {
+    if (size <= *capacity)
+        return 0;
+    if (poolReserve(size - *capacity) != 0)
+        return -1;
+    void *bigger = realloc(*buffer, size);
+    if (!bigger) {
+        poolUnreserve(size - *capacity);
+        return -1;
+    }
+    *buffer = bigger;
+    *capacity = size;
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function serves one client connection until it is closed. Every frame is read completely,
+ * each item is analyzed and timed on its own, and the replies go back as a single write. The analyzer
+ * context and the item buffer are reused across items and frames, so a long-lived connection does not
+ * allocate per request. The reply array and the item buffer count against --max-memory; a frame that
+ * does not fit the budget closes the connection, and the client then analyzes its arguments itself.
+ */
+static void serveConnection(int fd) {
+    clen_ctx *ctx = NULL;
+    ServeReply *replies = NULL;
+    size_t repliesCap = 0;
+    char *data = NULL;
+    size_t dataCap = 0;
+    ServeHeader header;
+
+    while (readFull(fd, &header, sizeof(header)) == 0) {
+        if (header.magic != SERVE_MAGIC || header.version != SERVE_VERSION || header.count > SERVE_MAX_ITEMS)
+            break;
+
+        if (!ctx || clen_metrics(ctx) != (header.metrics & CLEN_METRIC_ALL)) {
+            clen_free(ctx);
+            ctx = clen_new(header.metrics);
+        }
+        if (!ctx || growReserved((void **)&replies, &repliesCap, (header.count ? header.count : 1) * sizeof(ServeReply)) != 0)
+            break;
+
+        int ok = 1;
+        for (uint32_t i = 0; i < header.count && ok; i++) {
+            ServeItem item;
+            if (readFull(fd, &item, sizeof(item)) != 0 || item.length > SERVE_MAX_ITEM_BYTES) {
+                ok = 0;
+                break;
+            }
+            if (growReserved((void **)&data, &dataCap, (size_t)item.length + 1) != 0 || readFull(fd, data, item.length) != 0) {
+                ok = 0;
+                break;
+            }
+            data[item.length] = '\0';
+
+            struct timespec start, end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            ServeReply *reply = &replies[i];
+            memset(reply, 0, sizeof(*reply));
+            if (item.kind == SERVE_ITEM_PATH) {
+                errno = 0;
+                if (analyzeFile(data, ctx, &reply->result, NULL) != 0)
+                    reply->status = errno ? (uint32_t)errno : EIO;
+            } else {
+                clen_analyze(header.metrics, data, item.length, &reply->result);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            reply->nanos = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL + (uint64_t)(end.tv_nsec - start.tv_nsec);
+        }
+        if (!ok)
+            break;
+
+        header.status = SERVE_STATUS_OK;
+        if (writeFull(fd, &header, sizeof(header)) != 0 ||
+            writeFull(fd, replies, header.count * sizeof(ServeReply)) != 0)
+            break;
+    }
+
+    clen_free(ctx);
+    free(replies);
+    free(data);
+    poolUnreserve(repliesCap + dataCap);
+}
+
+
+
+
+
+/*
+ * Every worker of the pool blocks in accept() on the shared listening socket; the kernel hands each
+ * new connection to exactly one of them, so no extra queue or lock is needed. With --pin-threads each
+ * worker first pins itself to one CPU, chosen by its index.
+ */
+static int servePinThreads = 0;
+
+static void *serveWorker(void *arg) {
+    int index = (int)(intptr_t)arg;
+    if (servePinThreads && cpuPinThread(index) < 0)
+        fprintf(stderr, "Could not pin worker %d to a CPU\n", index);
+    for (;;) {
+        int fd = accept(serveListenFd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;
+        }
+        serveConnection(fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+
+
+
+
+/*
+ * This function removes the socket file at path, but only if it is a socket: a mistyped path must never
+ * cost the user a regular file. It returns 0 when path is gone or was never there, and -1 when something
+ * else is in the way. Only async-signal-safe calls are used, so serveStop() can use it too.
+ */
+static int removeSocket(const char *path) {
+    struct stat st;
+    if (lstat(path, &st) != 0)
+        return errno == ENOENT ? 0 : -1;
+    if (!S_ISSOCK(st.st_mode))
+        return -1;
+    return unlink(path) == 0 || errno == ENOENT ? 0 : -1;
+}
+
+
+
+
+
+/*
+ * The daemon removes its socket file when it is asked to stop, so the next start does not find a
+ * stale socket. Only async-signal-safe calls are used here.
+ */
+static void serveStop(int sig) {
+    (void)sig;
+    removeSocket(serveSocketPath);
+    _exit(0);
+}
+
+
+
+
+
+/*
+ * This function connects to the daemon socket. It returns the connected descriptor, or -1 when no
+ * daemon is listening on the given path.
+ */
+static int serveConnect(const char *socketPath) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path))
+        return -1;
+    strcpy(addr.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+
+
+
+
+/*
+ * This function runs CLEN as a persistent daemon listening on a Unix domain socket. It refuses to
+ * start when another daemon already answers on the path or when the path exists but is not a socket,
+ * replaces a stale socket file otherwise, and then serves clients with a pool of worker threads until it receives SIGINT or SIGTERM. The calling
+ * thread becomes worker 0; with pinThreads every worker is pinned to its own CPU.
+ *
+ * The daemon opens any path a client names with its own privileges, so the socket is created with mode
+ * 0600 and only the user running the daemon can connect to it.
+ */
+int serveRun(const char *socketPath, int threads, int pinThreads) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", socketPath);
+        return 1;
+    }
+    strcpy(addr.sun_path, socketPath);
+    strcpy(serveSocketPath, socketPath);
+
+    int probe = serveConnect(socketPath);
+    if (probe >= 0) {
+        close(probe);
+        fprintf(stderr, "A CLEN daemon is already serving on %s\n", socketPath);
+        return 1;
+    }
+    if (removeSocket(socketPath) != 0) {
+        fprintf(stderr, "Refusing to replace %s: it exists and is not a socket\n", socketPath);
+        return 1;
+    }
+
+    serveListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    mode_t mask = umask(0177);
+    int bound = serveListenFd >= 0 && bind(serveListenFd, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    umask(mask);
+    if (!bound || chmod(socketPath, 0600) != 0 || listen(serveListenFd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Could not listen on %s: %s\n", socketPath, strerror(errno));
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, serveStop);
+    signal(SIGTERM, serveStop);
+
+    if (threads < 1)
+        threads = 1;
+    printf("Serving on %s with %d %s\n", socketPath, threads, threads == 1 ? "worker" : "workers");
+    fflush(stdout);
+
+    servePinThreads = pinThreads;
+    for (int i = 1; i < threads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, serveWorker, (void *)(intptr_t)i) != 0) {
+            fprintf(stderr, "Could only start %d workers\n", i);
+            break;
+        }
+        pthread_detach(thread);
+    }
+    serveWorker((void *)(intptr_t)0);
+
+    removeSocket(socketPath);
+    return 1;
+}
+
+
+
+
+
+/*
+ * This function sends one batch of arguments to the daemon and collects the replies. File arguments
+ * (when fileContent is set) are sent as absolute paths so the daemon resolves them the same way the
+ * client would. It returns a malloc'd array of count replies, or NULL when no daemon is reachable or
+ * the exchange failed, in which case the caller analyzes the arguments locally instead.
+ */
+ServeReply *serveClientAnalyze(const char *socketPath, unsigned metrics, int fileContent, char *const *args, int count) {
+    int fd = serveConnect(socketPath);
+    if (fd < 0)
+        return NULL;
+
+    ServeReply *replies = malloc((count ? (size_t)count : 1) * sizeof(ServeReply));
+    char *frame = NULL;
+    size_t frameCap = 0;
+    int ok = replies != NULL;
+
+    for (int first = 0; ok && first < count; first += SERVE_MAX_ITEMS) {
+        uint32_t batch = (uint32_t)(count - first) < SERVE_MAX_ITEMS ? (uint32_t)(count - first) : SERVE_MAX_ITEMS;
+
+        size_t frameLen = sizeof(ServeHeader);
+        ServeHeader header = { SERVE_MAGIC, SERVE_VERSION, 0, metrics, batch };
+        for (uint32_t i = 0; ok && i < batch; i++) {
+            const char *arg = args[first + i];
+            char resolved[PATH_MAX];
+            ServeItem item = { SERVE_ITEM_TEXT, 0 };
+            if (fileContent && isFilePath(arg) && realpath(arg, resolved)) {
+                item.kind = SERVE_ITEM_PATH;
+                arg = resolved;
+            }
+            size_t len = strlen(arg);
+            if (len > SERVE_MAX_ITEM_BYTES) {
+                ok = 0;
+                break;
+            }
+            item.length = (uint32_t)len;
+
+            if (frameLen + sizeof(item) + len > frameCap &&
+                growReserved((void **)&frame, &frameCap, (frameLen + sizeof(item) + len) * 2) != 0) {
+                ok = 0;
+                break;
+            }
+            memcpy(frame + frameLen, &item, sizeof(item));
+            memcpy(frame + frameLen + sizeof(item), arg, len);
+            frameLen += sizeof(item) + len;
+        }
+        if (!ok)
+            break;
+        memcpy(frame, &header, sizeof(header));
+
+        ServeHeader answer;
+        if (writeFull(fd, frame, frameLen) != 0 ||
+            readFull(fd, &answer, sizeof(answer)) != 0 ||
+            answer.magic != SERVE_MAGIC || answer.status != SERVE_STATUS_OK || answer.count != batch ||
+            readFull(fd, replies + first, batch * sizeof(ServeReply)) != 0)
+            ok = 0;
+    }
+
+    close(fd);
+    free(frame);
+    poolUnreserve(frameCap);
+    if (!ok) {
+        free(replies);
+        return NULL;
+    }
+    return replies;
+}
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#ifndef CLEN_SERVE_H
+#define CLEN_SERVE_H
+
+#include <stdint.h>
+
+#include "clen.h"
+
+#define SERVE_DEFAULT_SOCKET "/run/clen.sock"
+
+/*
+ * One result record as sent back by the daemon for every item of a request. status is 0 on success
+ * or the errno value of a failed file read, and nanos is the time the daemon spent on the item.
+ */
+typedef struct {
+    uint32_t status;
+    uint32_t reserved;
+    uint64_t nanos;
+    clen_result result;
+} ServeReply;
+
+int serveRun(const char *socketPath, int threads, int pinThreads);
+ServeReply *serveClientAnalyze(const char *socketPath, unsigned metrics, int fileContent, char *const *args, int count);
+
+#endif
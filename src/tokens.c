@@ -0,0 +1,213 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <string.h>
+
+#include "tokens.h"
+
+
+
+/*
+ * The splitter cuts streamed input into words exactly as the analyzer counts them: maximal runs of
+ * bytes that are not whitespace (space, \t, \n, \v, \f, \r). A word that lies completely inside one
+ * chunk is handed to the handler straight from the chunk; only a word cut by a chunk boundary is
+ * carried over, in the prefix buffer and, once it outgrows the buffer, in a streaming hash.
+ */
+static const unsigned char isSpace[256] = {
+    [' '] = 1, ['\t'] = 1, ['\n'] = 1, ['\v'] = 1, ['\f'] = 1, ['\r'] = 1
+};
+
+
+
+
+
+/*
+ * This function prepares a splitter that reports words to handler.
+ */
+void wordsInit(WordSplitter *splitter, WordHandler handler, void *user) {
+    splitter->handler = handler;
+    splitter->user = user;
+    splitter->hashed = 1;
+    splitter->length = 0;
+}
+
+
+
+
+
+/*
+ * This function appends bytes to the word carried over from an earlier chunk.
+ */
+static void carry(WordSplitter *splitter, const unsigned char *p, size_t len) {
+    uint64_t before = splitter->length;
+    if (before < TOKEN_MAX_BYTES) {
+        size_t room = TOKEN_MAX_BYTES - (size_t)before;
+        memcpy(splitter->word + before, p, len < room ? len : room);
+    }
+    splitter->length += len;
+    if (splitter->length <= TOKEN_MAX_BYTES || !splitter->hashed)
+        return;
+    if (before <= TOKEN_MAX_BYTES) {
+        hashInit(&splitter->hash, 0);
+        hashUpdate(&splitter->hash, splitter->word, (size_t)before);
+    }
+    hashUpdate(&splitter->hash, p, len);
+}
+
+
+
+
+
+/*
+ * This function reports the carried-over word, if any, and clears it.
+ */
+static void flush(WordSplitter *splitter) {
+    if (!splitter->length)
+        return;
+    uint64_t length = splitter->length;
+    size_t stored = length < TOKEN_MAX_BYTES ? (size_t)length : TOKEN_MAX_BYTES;
+    uint64_t hash = !splitter->hashed ? 0 : length > TOKEN_MAX_BYTES ? hashFinal(&splitter->hash) : hash64(splitter->word, stored, 0);
+    splitter->handler(splitter->user, splitter->word, stored, length, hash);
+    splitter->length = 0;
+}
+
+
+
+
+
+/*
+ * This function feeds the next chunk of input. Words may be split at any byte boundary; they are
+ * reported once their end is seen.
+ */
+void wordsFeed(WordSplitter *splitter, const void *data, size_t len) {
+    const unsigned char *p = data;
+    const unsigned char *end = p + len;
+
+    if (splitter->length) {
+        const unsigned char *stop = p;
+        while (stop < end && !isSpace[*stop])
+            stop++;
+        carry(splitter, p, (size_t)(stop - p));
+        if (stop == end)
+            return;
+        flush(splitter);
+        p = stop;
+    }
+
+    while (p < end) {
+        while (p < end && isSpace[*p])
+            p++;
+        const unsigned char *start = p;
+        while (p < end && !isSpace[*p])
+            p++;
+        if (p == start)
+            break;
+        if (p == end) {
+            carry(splitter, start, (size_t)(p - start));
+            break;
+        }
+        size_t wordLen = (size_t)(p - start);
+        uint64_t hash = splitter->hashed ? hash64(start, wordLen, 0) : 0;
+        splitter->handler(splitter->user, start, wordLen <= TOKEN_MAX_BYTES ? wordLen : TOKEN_MAX_BYTES, wordLen, hash);
+    }
+}
+
+
+
+
+
+/*
+ * This function ends the input, reporting a word that runs up to its very end.
+ */
+void wordsFinish(WordSplitter *splitter) {
+    flush(splitter);
+}
+
+
+
+
+
+/*
+ * Lines are split at '\n' with memchr(), which the C library vectorizes. A line inside one chunk is
+ * hashed in one go; a line cut by a chunk boundary is hashed incrementally. An empty line between two
+ * newlines is a line of length 0, while input that ends with a newline has no extra empty line.
+ */
+void linesInit(LineSplitter *splitter, LineHandler handler, void *user) {
+    splitter->handler = handler;
+    splitter->user = user;
+    splitter->hashed = 1;
+    splitter->length = 0;
+}
+
+
+
+
+
+/*
+ * This function feeds the next chunk of input. Lines are reported once their newline is seen.
+ */
+void linesFeed(LineSplitter *splitter, const void *data, size_t len) {
+    const unsigned char *p = data;
+    const unsigned char *end = p + len;
+    while (p < end) {
+        const unsigned char *newline = memchr(p, '\n', (size_t)(end - p));
+        if (!newline) {
+            if (splitter->hashed) {
+                if (!splitter->length)
+                    hashInit(&splitter->hash, 0);
+                hashUpdate(&splitter->hash, p, (size_t)(end - p));
+            }
+            splitter->length += (uint64_t)(end - p);
+            return;
+        }
+        size_t lineLen = (size_t)(newline - p);
+        if (!splitter->hashed) {
+            splitter->handler(splitter->user, splitter->length + lineLen, 0);
+            splitter->length = 0;
+        } else if (splitter->length) {
+            hashUpdate(&splitter->hash, p, lineLen);
+            splitter->handler(splitter->user, splitter->length + lineLen, hashFinal(&splitter->hash));
+            splitter->length = 0;
+        } else {
+            splitter->handler(splitter->user, lineLen, hash64(p, lineLen, 0));
+        }
+        p = newline + 1;
+    }
+}
+
+
+
+
+
+/*
+ * This function ends the input, reporting a last line that has no newline.
+ */
+void linesFinish(LineSplitter *splitter) {
+    if (splitter->length)
+        splitter->handler(splitter->user, splitter->length, splitter->hashed ? hashFinal(&splitter->hash) : 0);
+    splitter->length = 0;
+}
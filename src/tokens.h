@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_TOKENS_H
+#define CLEN_TOKENS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash.h"
+
+#define TOKEN_MAX_BYTES 256
+
+/*
+ * Called for every complete word: its first bytes (at most TOKEN_MAX_BYTES), its full length and the
+ * XXH64 hash of all of its bytes, which identifies words longer than the prefix. The hash is 0 when the
+ * splitter was told not to compute it (hashed cleared after wordsInit()).
+ */
+typedef void (*WordHandler)(void *user, const unsigned char *word, size_t len, uint64_t length, uint64_t hash);
+
+typedef struct {
+    WordHandler handler;
+    void *user;
+    int hashed;
+    uint64_t length;
+    HashState hash;
+    unsigned char word[TOKEN_MAX_BYTES];
+} WordSplitter;
+
+/*
+ * Called for every line (without its '\n'): its length and the XXH64 hash of its bytes, or 0 when hashed
+ * was cleared after linesInit().
+ */
+typedef void (*LineHandler)(void *user, uint64_t length, uint64_t hash);
+
+typedef struct {
+    LineHandler handler;
+    void *user;
+    int hashed;
+    uint64_t length;
+    HashState hash;
+} LineSplitter;
+
+void wordsInit(WordSplitter *splitter, WordHandler handler, void *user);
+void wordsFeed(WordSplitter *splitter, const void *data, size_t len);
+void wordsFinish(WordSplitter *splitter);
+void linesInit(LineSplitter *splitter, LineHandler handler, void *user);
+void linesFeed(LineSplitter *splitter, const void *data, size_t len);
+void linesFinish(LineSplitter *splitter);
+
+#endif
@@ -0,0 +1,513 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "topwords.h"
+#include "tokens.h"
+
+
+
+/*
+ * Word frequencies are counted exactly for as long as the memory limit allows: an open-addressing
+ * table of (hash, count, word) slots with linear probing, whose word bytes are interned in an arena of
+ * large blocks, so counting a word that was seen before never allocates. Words longer than
+ * TOKEN_MAX_BYTES are told apart by their full 64-bit hash and keep only their prefix.
+ *
+ * When the table would grow past the limit (--top-words-memory), it switches to the Space-Saving
+ * algorithm: a fixed number m of counters, the most frequent words of the exact table seeding them.
+ * A word without a counter takes over the counter with the smallest count c and starts at c + 1,
+ * remembering c as its possible overestimate. Every count is then an upper bound that is at most the
+ * smallest counter value too high, and that value is at most (words seen) / m, so any word more
+ * frequent than that is guaranteed to be in the list. The smallest counter is found through a binary
+ * min-heap over the counters, the counter of a word through a hash index with backward-shift deletion.
+ */
+#define ARENA_BLOCK     (64 * 1024)
+#define EXACT_INITIAL   1024
+#define SKETCH_WORD     64
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t used;
+    unsigned char data[ARENA_BLOCK];
+} ArenaBlock;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t count;
+    unsigned char *word;
+    uint32_t len;
+    uint32_t truncated;
+} ExactSlot;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t count;
+    uint64_t error;
+    uint32_t heapIndex;
+    uint16_t len;
+    uint16_t truncated;
+    unsigned char word[SKETCH_WORD];
+} Counter;
+
+struct TopWords {
+    size_t k;
+    uint64_t memoryLimit;
+
+    ExactSlot *slots;
+    uint64_t slotCap;
+    uint64_t slotUsed;
+    ArenaBlock *arena;
+    uint64_t arenaBytes;
+
+    Counter *counters;
+    uint32_t counterCap;
+    uint32_t counterUsed;
+    uint32_t *heap;
+    uint32_t *index;
+    uint64_t indexMask;
+};
+
+
+
+
+
+/*
+ * This function copies word bytes into the arena and returns where they were stored.
+ */
+static unsigned char *intern(TopWords *top, const unsigned char *word, size_t len) {
+    if (!top->arena || top->arena->used + len > ARENA_BLOCK) {
+        ArenaBlock *block = malloc(sizeof(ArenaBlock));
+        if (!block)
+            return NULL;
+        block->next = top->arena;
+        block->used = 0;
+        top->arena = block;
+        top->arenaBytes += sizeof(ArenaBlock);
+    }
+    unsigned char *copy = top->arena->data + top->arena->used;
+    memcpy(copy, word, len);
+    top->arena->used += len;
+    return copy;
+}
+
+
+
+
+
+/*
+ * This function frees the exact table and its arena.
+ */
+static void freeExact(TopWords *top) {
+    while (top->arena) {
+        ArenaBlock *next = top->arena->next;
+        free(top->arena);
+        top->arena = next;
+    }
+    free(top->slots);
+    top->slots = NULL;
+    top->slotCap = top->slotUsed = 0;
+    top->arenaBytes = 0;
+}
+
+
+
+
+
+/*
+ * This function creates a counter for the k most frequent words. memoryLimit bounds the memory of the
+ * exact table in bytes before it switches to Space-Saving; 0 keeps counting exactly. Returns NULL when
+ * memory cannot be allocated.
+ */
+TopWords *topWordsNew(size_t k, uint64_t memoryLimit) {
+    TopWords *top = calloc(1, sizeof(*top));
+    if (!top)
+        return NULL;
+    top->k = k;
+    top->memoryLimit = memoryLimit;
+    top->slotCap = EXACT_INITIAL;
+    top->slots = calloc((size_t)top->slotCap, sizeof(ExactSlot));
+    if (!top->slots) {
+        topWordsFree(top);
+        return NULL;
+    }
+    return top;
+}
+
+
+
+
+
+/*
+ * This function releases a counter. Passing NULL is allowed.
+ */
+void topWordsFree(TopWords *top) {
+    if (!top)
+        return;
+    freeExact(top);
+    free(top->counters);
+    free(top->heap);
+    free(top->index);
+    free(top);
+}
+
+
+
+
+
+/*
+ * These functions keep the min-heap of counters ordered by count after a counter changed.
+ */
+static void heapSwap(TopWords *top, uint32_t a, uint32_t b) {
+    uint32_t ca = top->heap[a], cb = top->heap[b];
+    top->heap[a] = cb;
+    top->heap[b] = ca;
+    top->counters[cb].heapIndex = a;
+    top->counters[ca].heapIndex = b;
+}
+
+static void heapDown(TopWords *top, uint32_t i) {
+    for (;;) {
+        uint32_t smallest = i, left = 2 * i + 1, right = left + 1;
+        if (left < top->counterUsed && top->counters[top->heap[left]].count < top->counters[top->heap[smallest]].count)
+            smallest = left;
+        if (right < top->counterUsed && top->counters[top->heap[right]].count < top->counters[top->heap[smallest]].count)
+            smallest = right;
+        if (smallest == i)
+            return;
+        heapSwap(top, i, smallest);
+        i = smallest;
+    }
+}
+
+static void heapUp(TopWords *top, uint32_t i) {
+    while (i > 0 && top->counters[top->heap[(i - 1) / 2]].count > top->counters[top->heap[i]].count) {
+        heapSwap(top, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+
+
+
+
+/*
+ * This function finds the index slot of a word in Space-Saving mode; the slot is empty (0) when the
+ * word has no counter.
+ */
+static uint64_t indexFind(const TopWords *top, const unsigned char *word, size_t len, uint64_t hash) {
+    uint64_t i = hash & top->indexMask;
+    for (; top->index[i]; i = (i + 1) & top->indexMask) {
+        const Counter *c = &top->counters[top->index[i] - 1];
+        size_t stored = len < SKETCH_WORD ? len : SKETCH_WORD;
+        if (c->hash == hash && c->len == stored && memcmp(c->word, word, stored) == 0)
+            break;
+    }
+    return i;
+}
+
+
+
+
+
+/*
+ * This function removes a counter from the index, shifting later entries of its probe run back so
+ * lookups never need tombstones.
+ */
+static void indexRemove(TopWords *top, uint64_t i) {
+    top->index[i] = 0;
+    for (uint64_t j = (i + 1) & top->indexMask; top->index[j]; j = (j + 1) & top->indexMask) {
+        uint64_t home = top->counters[top->index[j] - 1].hash & top->indexMask;
+        if (((j - home) & top->indexMask) >= ((j - i) & top->indexMask)) {
+            top->index[i] = top->index[j];
+            top->index[j] = 0;
+            i = j;
+        }
+    }
+}
+
+
+
+
+
+/*
+ * This function stores a word into a counter.
+ */
+static void setCounterWord(Counter *c, const unsigned char *word, size_t len, int truncated, uint64_t hash) {
+    size_t stored = len < SKETCH_WORD ? len : SKETCH_WORD;
+    memcpy(c->word, word, stored);
+    c->len = (uint16_t)stored;
+    c->truncated = (uint16_t)(truncated || stored < len);
+    c->hash = hash;
+}
+
+
+
+
+
+/*
+ * This function counts a word in Space-Saving mode.
+ */
+static void sketchAdd(TopWords *top, const unsigned char *word, size_t len, int truncated, uint64_t hash, uint64_t count, uint64_t error) {
+    uint64_t slot = indexFind(top, word, len, hash);
+    if (top->index[slot]) {
+        Counter *c = &top->counters[top->index[slot] - 1];
+        c->count += count;
+        heapDown(top, c->heapIndex);
+        return;
+    }
+
+    uint32_t id;
+    if (top->counterUsed < top->counterCap) {
+        id = top->counterUsed;
+        top->counters[id].count = 0;
+        top->counters[id].error = 0;
+        top->counters[id].heapIndex = top->counterUsed;
+        top->heap[top->counterUsed++] = id;
+    } else {
+        id = top->heap[0];
+        Counter *victim = &top->counters[id];
+        indexRemove(top, indexFind(top, victim->word, victim->len, victim->hash));
+        victim->error = victim->count + error;
+        slot = indexFind(top, word, len, hash);
+    }
+
+    Counter *c = &top->counters[id];
+    setCounterWord(c, word, len, truncated, hash);
+    c->count += count;
+    top->index[slot] = id + 1;
+    heapDown(top, c->heapIndex);
+    heapUp(top, c->heapIndex);
+}
+
+
+
+
+
+/*
+ * This function compares exact slots by descending count, for seeding the sketch.
+ */
+static int byCountDesc(const void *a, const void *b) {
+    const ExactSlot *x = a, *y = b;
+    return x->count < y->count ? 1 : x->count > y->count ? -1 : 0;
+}
+
+
+
+
+
+/*
+ * This function switches from exact counting to Space-Saving within the memory limit, keeping the most
+ * frequent words seen so far with their exact counts. It returns -1 if the sketch cannot be allocated.
+ */
+static int switchToSketch(TopWords *top) {
+    uint64_t perCounter = sizeof(Counter) + sizeof(uint32_t) + 2 * sizeof(uint32_t);
+    uint64_t cap = top->memoryLimit / perCounter;
+    if (cap < top->k)
+        cap = top->k;
+    if (cap < 1)
+        cap = 1;
+    if (cap > UINT32_MAX / 4)
+        cap = UINT32_MAX / 4;
+    uint64_t indexCap = 1;
+    while (indexCap < 2 * cap)
+        indexCap <<= 1;
+
+    Counter *counters = calloc((size_t)cap, sizeof(Counter));
+    uint32_t *heap = calloc((size_t)cap, sizeof(uint32_t));
+    uint32_t *index = calloc((size_t)indexCap, sizeof(uint32_t));
+    if (!counters || !heap || !index) {
+        free(counters);
+        free(heap);
+        free(index);
+        return -1;
+    }
+    top->counters = counters;
+    top->heap = heap;
+    top->index = index;
+    top->counterCap = (uint32_t)cap;
+    top->indexMask = indexCap - 1;
+
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < top->slotCap; i++)
+        if (top->slots[i].count)
+            top->slots[used++] = top->slots[i];
+    qsort(top->slots, (size_t)used, sizeof(ExactSlot), byCountDesc);
+    for (uint64_t i = 0; i < used && i < cap; i++)
+        sketchAdd(top, top->slots[i].word, top->slots[i].len, (int)top->slots[i].truncated, top->slots[i].hash, top->slots[i].count, 0);
+    freeExact(top);
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function doubles the exact table, or switches to the sketch when that would break the limit.
+ */
+static int growExact(TopWords *top) {
+    uint64_t newCap = top->slotCap * 2;
+    if (top->memoryLimit && newCap * sizeof(ExactSlot) + top->arenaBytes > top->memoryLimit)
+        return switchToSketch(top);
+
+    ExactSlot *grown = calloc((size_t)newCap, sizeof(ExactSlot));
+    if (!grown)
+        return top->memoryLimit ? switchToSketch(top) : -1;
+    for (uint64_t i = 0; i < top->slotCap; i++) {
+        if (!top->slots[i].count)
+            continue;
+        uint64_t j = top->slots[i].hash & (newCap - 1);
+        while (grown[j].count)
+            j = (j + 1) & (newCap - 1);
+        grown[j] = top->slots[i];
+    }
+    free(top->slots);
+    top->slots = grown;
+    top->slotCap = newCap;
+    return 0;
+}
+
+
+
+
+
+/*
+ * This function counts one occurrence of a word: its stored bytes, its full length and its hash as
+ * reported by the word splitter.
+ */
+void topWordsAdd(TopWords *top, const unsigned char *word, size_t len, uint64_t length, uint64_t hash) {
+    int truncated = length > len;
+    if (top->counters) {
+        sketchAdd(top, word, len, truncated, hash, 1, 0);
+        return;
+    }
+
+    uint64_t mask = top->slotCap - 1;
+    uint64_t i = hash & mask;
+    for (; top->slots[i].count; i = (i + 1) & mask) {
+        ExactSlot *slot = &top->slots[i];
+        if (slot->hash == hash && slot->len == len && memcmp(slot->word, word, len) == 0) {
+            slot->count++;
+            return;
+        }
+    }
+
+    int needBlock = !top->arena || top->arena->used + len > ARENA_BLOCK;
+    if (top->memoryLimit && top->slotCap * sizeof(ExactSlot) + top->arenaBytes + (needBlock ? sizeof(ArenaBlock) : 0) > top->memoryLimit) {
+        if (switchToSketch(top) == 0)
+            sketchAdd(top, word, len, truncated, hash, 1, 0);
+        return;
+    }
+    if ((top->slotUsed + 1) * 10 > top->slotCap * 7) {
+        if (growExact(top) == 0)
+            topWordsAdd(top, word, len, length, hash);
+        return;
+    }
+
+    unsigned char *copy = intern(top, word, len);
+    if (!copy)
+        return;
+    top->slots[i] = (ExactSlot){ hash, 1, copy, (uint32_t)len, (uint32_t)truncated };
+    top->slotUsed++;
+}
+
+
+
+
+
+/*
+ * This function offers a candidate to the sorted list of the n best entries found so far, keeping at
+ * most k of them.
+ */
+static void offer(TopWord *out, size_t *n, size_t k, const TopWord *candidate) {
+    size_t at;
+    if (*n < k)
+        at = (*n)++;
+    else if (k && candidate->count > out[k - 1].count)
+        at = k - 1;
+    else
+        return;
+    for (; at > 0 && out[at - 1].count < candidate->count; at--)
+        out[at] = out[at - 1];
+    out[at] = *candidate;
+}
+
+
+
+
+
+/*
+ * This function fills out (room for k entries) with the most frequent words, most frequent first,
+ * and returns how many there are. The entries point into the counter and stay valid until the next
+ * topWordsAdd().
+ */
+size_t topWordsList(const TopWords *top, TopWord *out) {
+    size_t n = 0;
+    if (top->counters) {
+        for (uint32_t i = 0; i < top->counterUsed; i++) {
+            const Counter *c = &top->counters[i];
+            TopWord candidate = { c->word, c->len, c->truncated, c->count, c->error };
+            offer(out, &n, top->k, &candidate);
+        }
+    } else {
+        for (uint64_t i = 0; i < top->slotCap; i++) {
+            const ExactSlot *s = &top->slots[i];
+            if (!s->count)
+                continue;
+            TopWord candidate = { s->word, s->len, (int)s->truncated, s->count, 0 };
+            offer(out, &n, top->k, &candidate);
+        }
+    }
+    return n;
+}
+
+
+
+
+
+/*
+ * This function tells whether the counts are Space-Saving estimates rather than exact.
+ */
+int topWordsApproximate(const TopWords *top) {
+    return top->counters != NULL;
+}
+
+
+
+
+
+/*
+ * This function returns how much any estimated count can overstate the true count at most: the
+ * smallest counter value once every counter is in use, 0 while counting exactly.
+ */
+uint64_t topWordsErrorBound(const TopWords *top) {
+    if (!top->counters || top->counterUsed < top->counterCap)
+        return 0;
+    return top->counters[top->heap[0]].count;
+}
@@ -0,0 +1,55 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 CLEN - By Ibrahim Yousef Alshaibani
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+
+#ifndef CLEN_TOPWORDS_H
+#define CLEN_TOPWORDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * One entry of a top-K list. word points at up to len stored bytes (truncated when the word is longer
+ * than TOKEN_MAX_BYTES). In approximate mode count may overstate the true count by at most error.
+ */
+typedef struct {
+    const unsigned char *word;
+    size_t len;
+    int truncated;
+    uint64_t count;
+    uint64_t error;
+} TopWord;
+
+typedef struct TopWords TopWords;
+
+TopWords *topWordsNew(size_t k, uint64_t memoryLimit);
+void topWordsFree(TopWords *top);
+void topWordsAdd(TopWords *top, const unsigned char *word, size_t len, uint64_t length, uint64_t hash);
+size_t topWordsList(const TopWords *top, TopWord *out);
+int topWordsApproximate(const TopWords *top);
+uint64_t topWordsErrorBound(const TopWords *top);
+
+#endif